@@ -8,8 +8,12 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include(chess960-core.pri)
+
 HEADERS += \
+    analysisworker.h \
     clickablelabel.h \
+    engineworker.h \
     gamewindow.h \
     guidewindow.h \
     mainwindow.h \
@@ -18,7 +22,9 @@ HEADERS += \
     promotiondialog.h \
     piece_logic.h
 SOURCES += \
+    analysisworker.cpp \
     clickablelabel.cpp \
+    engineworker.cpp \
     gamewindow.cpp \
     guidewindow.cpp \
     main.cpp \
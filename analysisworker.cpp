@@ -0,0 +1,30 @@
+#include "analysisworker.h"
+#include <QMetaType>
+
+namespace {
+
+// Таблица перестановок каждого потока анализа: позиции соседние, много памяти не нужно.
+const size_t AnalysisHashMb = 8;
+
+} // namespace
+
+AnalysisWorker::AnalysisWorker(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<PositionAnalysis>("PositionAnalysis");
+}
+
+AnalysisWorker::~AnalysisWorker()
+{
+    m_analysis.stop();
+}
+
+int AnalysisWorker::start(const std::vector<Position>& positions, const std::vector<uint64_t>& keys,
+                          const SearchLimits& limits, int threads)
+{
+    int analysisId = ++m_lastAnalysisId;
+    m_analysis.start(positions, keys, limits, threads, AnalysisHashMb, [this, analysisId](const PositionAnalysis& analysis) {
+        emit positionAnalysed(analysisId, analysis);
+    });
+    return analysisId;
+}
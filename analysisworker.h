@@ -0,0 +1,39 @@
+#ifndef ANALYSISWORKER_H
+#define ANALYSISWORKER_H
+
+#include "game_analysis.h"
+#include <QObject>
+
+/**
+ * @class AnalysisWorker
+ * @brief Анализ законченной партии для интерфейса: Qt-обертка над GameAnalysis.
+ *
+ * Позиции оцениваются в пуле потоков, и каждая готовая оценка приходит окну
+ * сигналом positionAnalysed (из потока анализа, доставка отложенная). Как и у
+ * EngineWorker, каждый анализ получает номер: результаты прерванного анализа
+ * окно узнает по номеру и отбрасывает.
+ */
+class AnalysisWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AnalysisWorker(QObject *parent = nullptr);
+    // Прерывает анализ и дожидается потоков.
+    ~AnalysisWorker() override;
+
+    // Начинает анализ, прерывая предыдущий; возвращает номер анализа.
+    int start(const std::vector<Position>& positions, const std::vector<uint64_t>& keys,
+              const SearchLimits& limits, int threads);
+    void stop() { m_analysis.stop(); }
+    bool isRunning() const { return m_analysis.isRunning(); }
+
+signals:
+    void positionAnalysed(int analysisId, const PositionAnalysis& analysis);
+
+private:
+    GameAnalysis m_analysis;
+    int m_lastAnalysisId = 0;
+};
+
+#endif // ANALYSISWORKER_H
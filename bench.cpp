@@ -0,0 +1,317 @@
+#include "evaluate.h"
+#include "nnue.h"
+#include "search.h"
+#include "startpos.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * chess960-bench — замер скорости движка: поиск фиксированной глубины
+ * на постоянном наборе позиций (стартовые позиции Chess960 и миттельшпили).
+ * В одном потоке число узлов детерминировано и служит подписью движка:
+ * если оно изменилось, изменился и сам поиск.
+ *
+ *   chess960-bench [-d N] [--hash MB] [--threads N] [--target-nps N] [--json FILE]
+ *   chess960-bench [-d N] [--hash MB] --ttd N       время до глубины на 1, 2, 4 ... N потоках
+ *   chess960-bench --eval "<FEN>"                    оценка позиции по слагаемым
+ *   chess960-bench [--nnue FILE] --nnue-speed        оценок сети в секунду на скалярных и SIMD-ядрах
+ *
+ * --nnue FILE загружает веса сети: поиск оценивает позиции ею. Без файла
+ * --nnue-speed замеряет сеть со случайными весами (скорость от весов не зависит).
+ *
+ * Перед каждой позицией таблица перестановок очищается, чтобы результат
+ * не зависел от порядка позиций.
+ *
+ * --json FILE записывает статистику поиска каждой позиции (SearchStats::toJson)
+ * строкой JSON: узлы, отсечения, попадания в таблицу, время итераций.
+ *
+ * С --target-nps программа завершается с кодом 1, если скорость ниже цели.
+ */
+
+namespace {
+
+const int DefaultBenchDepth = 7;
+
+struct BenchPosition {
+    const char* label;
+    int spIndex;        // -1 — позиция задана FEN.
+    const char* fen;
+};
+
+const BenchPosition BenchPositions[] = {
+    { "SP 518",    518, nullptr },
+    { "SP 0",        0, nullptr },
+    { "SP 959",    959, nullptr },
+    { "SP 272",    272, nullptr },
+    { "kiwipete",   -1, "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" },
+    { "endgame",    -1, "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1" },
+    { "pos4",       -1, "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1" },
+    { "pos5",       -1, "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8" },
+    { "960-a",      -1, "bqnb1rkr/pp3ppp/3ppn2/2p5/5P2/P2P4/NPP1P1PP/BQ1BNRKR w HFhf - 2 9" },
+    { "960-b",      -1, "2nnrbkr/p1qppppp/8/1ppb4/6PP/3PP3/PPP2P2/BQNNRBKR w HEhe - 1 9" },
+};
+
+struct BenchTotals {
+    uint64_t nodes = 0;
+    double seconds = 0;
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+};
+
+// Ищет все позиции набора до глубины depth; verbose — печатать строку на позицию,
+// json — файл для статистики поиска по позициям (может быть nullptr).
+bool runBench(Search& search, int depth, bool verbose, BenchTotals& totals, std::FILE* json = nullptr) {
+    SearchLimits limits;
+    limits.depth = depth;
+    for (const BenchPosition& bench : BenchPositions) {
+        Position position;
+        if (bench.spIndex >= 0) {
+            setupStartPosition(position, bench.spIndex);
+        } else if (!position.setFromFen(bench.fen)) {
+            std::fprintf(stderr, "Invalid FEN: %s\n", bench.fen);
+            return false;
+        }
+        TranspositionTable& tt = search.transpositionTable();
+        tt.clear();
+        SearchResult result = search.think(position, limits);
+        totals.nodes += result.nodes;
+        totals.seconds += result.seconds;
+        totals.probes += tt.probes();
+        totals.hits += tt.hits();
+        if (json) std::fprintf(json, "{\"position\":\"%s\",\"stats\":%s}\n", bench.label, result.stats.toJson().c_str());
+        if (!verbose) continue;
+        std::printf("%-9s depth %d  best %-6s score %6d  nodes %10llu  time %.3fs  nps %.0f  tt hits %.1f%%  hashfull %d\n",
+                    bench.label, result.depth, moveToString(result.bestMove).c_str(), result.score,
+                    static_cast<unsigned long long>(result.nodes), result.seconds,
+                    result.seconds > 0 ? result.nodes / result.seconds : 0.0,
+                    tt.hitRate() * 100, tt.hashfull());
+        std::printf("          seldepth %d  qnodes %.1f%%  first-move cutoffs %.1f%%\n", result.stats.totals.selDepth,
+                    result.stats.qnodeShare() * 100, result.stats.firstMoveCutoffRate() * 100);
+        if (result.threadNodes.size() > 1) {
+            std::printf("          threads:");
+            for (uint64_t nodes : result.threadNodes) std::printf(" %llu", static_cast<unsigned long long>(nodes));
+            std::printf("\n");
+        }
+    }
+    return true;
+}
+
+// Время до глубины: один и тот же набор на 1, 2, 4 ... maxThreads потоках.
+int runTimeToDepth(Search& search, int depth, int maxThreads) {
+    double baseSeconds = 0;
+    for (int threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        search.setThreads(threads);
+        BenchTotals totals;
+        if (!runBench(search, depth, false, totals)) return 2;
+        if (threads == 1) baseSeconds = totals.seconds;
+        std::printf("threads %3d  depth %d  time %.3fs  speedup %.2f  nodes %llu  nps %.0f\n",
+                    threads, depth, totals.seconds, totals.seconds > 0 ? baseSeconds / totals.seconds : 0.0,
+                    static_cast<unsigned long long>(totals.nodes),
+                    totals.seconds > 0 ? totals.nodes / totals.seconds : 0.0);
+        if (threads >= maxThreads) break;
+    }
+    return 0;
+}
+
+// Печатает оценку позиции по слагаемым (миттельшпиль / эндшпиль, с точки зрения белых).
+int printEvalBreakdown(const std::string& fen) {
+    Position position;
+    if (!position.setFromFen(fen)) {
+        std::fprintf(stderr, "Invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+    EvalBreakdown eval = evaluateBreakdown(position);
+    std::printf("%-12s %6s %6s\n", "term", "mg", "eg");
+    std::printf("%-12s %6d %6d\n", "material", eval.material.mg, eval.material.eg);
+    std::printf("%-12s %6d %6d\n", "piece-square", eval.pieceSquare.mg, eval.pieceSquare.eg);
+    std::printf("%-12s %6d %6d\n", "mobility", eval.mobility.mg, eval.mobility.eg);
+    std::printf("phase %d/%d  total %d (white)  evaluate() %d (side to move)\n",
+                eval.phase, Psqt::MaxPhase, eval.total, evaluate(position));
+    if (!eval.incrementalMatches) {
+        std::printf("Incremental material/PST differ from a full recount\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Скорость оценки сетью на каждом доступном наборе ядер: полный пересчет
+// аккумулятора и инкрементальное обновление после хода. Результаты всех ядер
+// должны совпадать до бита.
+int runNnueSpeed() {
+    if (!Nnue::isLoaded()) {
+        Nnue::setRandomNetwork(1);
+        std::printf("Network: random weights\n");
+    }
+
+    // Позиции из случайных партий от позиций набора.
+    std::vector<Position> samples;
+    std::mt19937 random(2024);
+    for (const BenchPosition& bench : BenchPositions) {
+        Position position;
+        if (bench.spIndex >= 0) setupStartPosition(position, bench.spIndex);
+        else position.setFromFen(bench.fen);
+        for (int ply = 0; ply < 60; ++ply) {
+            MoveList moves;
+            generateLegalMoves(position, moves);
+            if (moves.empty()) break;
+            UndoInfo undo;
+            position.makeMove(moves[random() % moves.size], undo);
+            samples.push_back(position);
+        }
+    }
+
+    const int rounds = 40;
+    double scalarFull = 0, scalarIncremental = 0;
+    int64_t referenceChecksum = 0;
+    bool consistent = true;
+    for (int level = Nnue::SIMD_SCALAR; level <= Nnue::bestSimdLevel(); ++level) {
+        Nnue::setSimdLevel(static_cast<Nnue::SimdLevel>(level));
+        Nnue::Accumulator accumulator, child, refreshed;
+        int64_t checksum = 0;
+
+        uint64_t fullEvals = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (const Position& position : samples) {
+                Nnue::refreshAccumulator(position, accumulator);
+                checksum += Nnue::evaluate(accumulator, position.sideToMove());
+                ++fullEvals;
+            }
+        }
+        double fullSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t incrementalEvals = 0;
+        double incrementalSeconds = 0;
+        for (Position position : samples) {
+            MoveList moves;
+            generateLegalMoves(position, moves);
+            Nnue::refreshAccumulator(position, accumulator);
+            start = std::chrono::steady_clock::now();
+            for (int round = 0; round < rounds / 4; ++round) {
+                for (PackedMove move : moves) {
+                    UndoInfo undo;
+                    position.makeMove(move, undo);
+                    Nnue::updateAccumulator(accumulator, child, position, move, undo);
+                    checksum += Nnue::evaluate(child, position.sideToMove());
+                    position.unmakeMove(move, undo);
+                    ++incrementalEvals;
+                }
+            }
+            incrementalSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            // Вне замера: обновление должно давать тот же аккумулятор, что и пересчет.
+            for (PackedMove move : moves) {
+                UndoInfo undo;
+                position.makeMove(move, undo);
+                Nnue::updateAccumulator(accumulator, child, position, move, undo);
+                Nnue::refreshAccumulator(position, refreshed);
+                if (std::memcmp(&child, &refreshed, sizeof(child)) != 0) consistent = false;
+                position.unmakeMove(move, undo);
+            }
+        }
+
+        double fullRate = fullSeconds > 0 ? fullEvals / fullSeconds : 0.0;
+        double incrementalRate = incrementalSeconds > 0 ? incrementalEvals / incrementalSeconds : 0.0;
+        if (level == Nnue::SIMD_SCALAR) {
+            scalarFull = fullRate;
+            scalarIncremental = incrementalRate;
+            referenceChecksum = checksum;
+        } else if (checksum != referenceChecksum) {
+            consistent = false;
+        }
+        std::printf("%-7s refresh+eval %10.0f evals/s (x%.2f)  update+eval %10.0f evals/s (x%.2f)\n",
+                    Nnue::simdLevelName(static_cast<Nnue::SimdLevel>(level)),
+                    fullRate, scalarFull > 0 ? fullRate / scalarFull : 0.0,
+                    incrementalRate, scalarIncremental > 0 ? incrementalRate / scalarIncremental : 0.0);
+    }
+    Nnue::setSimdLevel(Nnue::bestSimdLevel());
+    if (!consistent) {
+        std::printf("Kernels or incremental updates disagree\n");
+        return 1;
+    }
+    return 0;
+}
+
+void printUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [-d depth] [--hash MB] [--threads N] [--nnue FILE] [--target-nps N] [--ttd maxThreads] [--json FILE]\n"
+                 "       %s --eval \"<FEN>\"\n"
+                 "       %s [--nnue FILE] --nnue-speed\n", program, program, program);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int depth = DefaultBenchDepth;
+    double targetNps = 0;
+    size_t hashMb = TranspositionTable::DefaultSizeMb;
+    int threads = 1;
+    int ttdThreads = 0;
+    std::string evalFen;
+    std::string networkFile;
+    bool nnueSpeed = false;
+    std::string jsonFile;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((arg == "-d" || arg == "--depth") && hasValue) depth = std::atoi(argv[++i]);
+        else if (arg == "--hash" && hasValue) hashMb = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && hasValue) threads = std::atoi(argv[++i]);
+        else if (arg == "--ttd" && hasValue) ttdThreads = std::atoi(argv[++i]);
+        else if (arg == "--eval" && hasValue) evalFen = argv[++i];
+        else if (arg == "--nnue" && hasValue) networkFile = argv[++i];
+        else if (arg == "--nnue-speed") nnueSpeed = true;
+        else if (arg == "--target-nps" && hasValue) targetNps = std::atof(argv[++i]);
+        else if (arg == "--json" && hasValue) jsonFile = argv[++i];
+        else { printUsage(argv[0]); return 2; }
+    }
+    if (depth < 1 || depth > MaxSearchDepth || threads < 1 || threads > Search::MaxThreads
+        || ttdThreads < 0 || ttdThreads > Search::MaxThreads) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    if (!evalFen.empty()) return printEvalBreakdown(evalFen);
+    if (!networkFile.empty()) {
+        std::string error;
+        if (!Nnue::loadNetwork(networkFile, &error)) {
+            std::fprintf(stderr, "Cannot load network: %s\n", error.c_str());
+            return 2;
+        }
+        std::printf("Network: %s (%s kernels)\n", networkFile.c_str(), Nnue::simdLevelName(Nnue::simdLevel()));
+    }
+    if (nnueSpeed) return runNnueSpeed();
+
+    Search search;
+    search.setHashSizeMb(hashMb);
+    if (ttdThreads > 0) return runTimeToDepth(search, depth, ttdThreads);
+    search.setThreads(threads);
+
+    std::FILE* json = nullptr;
+    if (!jsonFile.empty() && !(json = std::fopen(jsonFile.c_str(), "w"))) {
+        std::fprintf(stderr, "Cannot create %s\n", jsonFile.c_str());
+        return 2;
+    }
+    BenchTotals totals;
+    bool completed = runBench(search, depth, true, totals, json);
+    if (json) std::fclose(json);
+    if (!completed) return 2;
+
+    double nps = totals.seconds > 0 ? totals.nodes / totals.seconds : 0.0;
+    std::printf("Total: nodes %llu  time %.3fs  nps %.0f  tt hits %.1f%%  hash %zu MB  threads %d\n",
+                static_cast<unsigned long long>(totals.nodes), totals.seconds, nps,
+                totals.probes ? 100.0 * totals.hits / totals.probes : 0.0, search.transpositionTable().sizeMb(),
+                search.threads());
+    if (targetNps > 0 && nps < targetNps) {
+        std::printf("Below target: %.0f nps < %.0f nps\n", nps, targetNps);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "bitboard.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+namespace BitboardTables {
+
+bool UsePext = false;
+Magic BishopMagics[64];
+Magic RookMagics[64];
+
+} // namespace BitboardTables
+
+namespace {
+
+using namespace BitboardTables;
+
+// Суммарное число подмножеств масок по всем клеткам: 2^(число клеток маски).
+Bitboard RookTable[0x19000];
+Bitboard BishopTable[0x1480];
+
+const int BishopDirs[4] = {1, 3, 5, 7};
+const int RookDirs[4] = {0, 2, 4, 6};
+
+Bitboard slidingAttacks(const int (&dirs)[4], int square, Bitboard occupied) {
+    return rayAttacks(dirs[0], square, occupied) | rayAttacks(dirs[1], square, occupied)
+         | rayAttacks(dirs[2], square, occupied) | rayAttacks(dirs[3], square, occupied);
+}
+
+// Псевдослучайные числа с малым числом единиц — хорошие кандидаты в магические множители.
+struct SparseRandom {
+    uint64_t state;
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+    uint64_t sparse() { return next() & next() & next(); }
+};
+
+void initMagics(const int (&dirs)[4], Magic magics[64], Bitboard* table, bool usePext) {
+    // Начальные значения генератора по горизонталям: с ними поиск занимает миллисекунды.
+    static const uint64_t Seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+    Bitboard occupancy[4096], reference[4096];
+    int epoch[4096] = {}, attempt = 0;
+
+    for (int square = 0; square < 64; ++square) {
+        Magic& m = magics[square];
+        // Крайние клетки луча не влияют на атаку: за ними все равно ничего нет.
+        Bitboard edges = ((RowBB[0] | RowBB[7]) & ~RowBB[squareRow(square)])
+                       | ((ColABB | ColHBB) & ~(ColABB << squareCol(square)));
+        m.mask = slidingAttacks(dirs, square, 0) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = (square == 0) ? table : magics[square - 1].attacks + (1 << (64 - magics[square - 1].shift));
+
+        // Перебор всех подмножеств маски (Carry-Rippler).
+        int size = 0;
+        Bitboard subset = 0;
+        do {
+            occupancy[size] = subset;
+            reference[size] = slidingAttacks(dirs, square, subset);
+            if (usePext) m.attacks[pext(subset, m.mask)] = reference[size];
+            ++size;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+        if (usePext) continue;
+
+        // Ищем множитель без вредных коллизий; epoch избавляет от очистки таблицы.
+        SparseRandom rng{Seeds[squareRow(square)]};
+        for (int i = 0; i < size;) {
+            for (m.magic = 0; popCount((m.mask * m.magic) >> 56) < 6;) m.magic = rng.sparse();
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                } else if (m.attacks[idx] != reference[i]) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+}
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned>(info[i]);
+}
+#endif
+
+// Заполнение таблиц до main(): атаки нужны с первого же хода.
+struct SlidingAttacksInit {
+    SlidingAttacksInit() { initSlidingAttacks(); }
+} slidingAttacksInit;
+
+} // namespace
+
+bool cpuHasFastPext() {
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+    unsigned regs[4];
+    cpuid(0, 0, regs);
+    if (regs[0] < 7) return false;
+    bool isAmd = regs[1] == 0x68747541; // "Auth" из "AuthenticAMD".
+    cpuid(7, 0, regs);
+    if (!(regs[1] & (1u << 8))) return false; // BMI2.
+    if (!isAmd) return true;
+    // На AMD до Zen 3 PEXT выполняется микрокодом и медленнее умножения.
+    cpuid(1, 0, regs);
+    unsigned family = ((regs[0] >> 8) & 0xF) + ((regs[0] >> 20) & 0xFF);
+    return family >= 0x19;
+#else
+    return false;
+#endif
+}
+
+bool cpuHasSse41() {
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+    unsigned regs[4];
+    cpuid(1, 0, regs);
+    return (regs[2] & (1u << 19)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool cpuHasAvx2() {
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+    unsigned regs[4];
+    cpuid(0, 0, regs);
+    if (regs[0] < 7) return false;
+    cpuid(1, 0, regs);
+    // ОС должна сохранять регистры YMM при переключении задач (OSXSAVE + XCR0 биты 1 и 2).
+    if (!(regs[2] & (1u << 27)) || !(regs[2] & (1u << 28))) return false;
+#if defined(_MSC_VER)
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    unsigned long long xcr0 = (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+    if ((xcr0 & 6) != 6) return false;
+    cpuid(7, 0, regs);
+    return (regs[1] & (1u << 5)) != 0;
+#else
+    return false;
+#endif
+}
+
+void initSlidingAttacks(bool allowPext) {
+    bool usePext = allowPext && cpuHasFastPext();
+    UsePext = usePext;
+    initMagics(BishopDirs, BishopMagics, BishopTable, usePext);
+    initMagics(RookDirs, RookMagics, RookTable, usePext);
+}
@@ -0,0 +1,223 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "chess_types.h"
+#include <array>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+// 64-битное множество клеток. Бит с номером square = row * 8 + col,
+// т.е. нулевой бит — a8 (row 0), 63-й бит — h1 (row 7), как и в истории партии.
+typedef uint64_t Bitboard;
+
+inline int makeSquare(int row, int col) { return row * 8 + col; }
+inline int squareRow(int square) { return square >> 3; }
+inline int squareCol(int square) { return square & 7; }
+inline Bitboard squareBB(int square) { return Bitboard(1) << square; }
+
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Индекс младшего/старшего установленного бита. Для пустого множества не определено.
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER)
+    unsigned long idx; _BitScanForward64(&idx, b); return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+inline int msb(Bitboard b) {
+#if defined(_MSC_VER)
+    unsigned long idx; _BitScanReverse64(&idx, b); return static_cast<int>(idx);
+#else
+    return 63 - __builtin_clzll(b);
+#endif
+}
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+// Инструкция BMI2 PEXT: собирает биты src, отмеченные в mask, в младшие разряды.
+// Вызывается только если процессор ее поддерживает (см. BitboardTables::UsePext),
+// поэтому вставляется напрямую, без сборки всей программы с -mbmi2.
+inline uint64_t pext(uint64_t src, uint64_t mask) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return _pext_u64(src, mask);
+#elif defined(__GNUC__) && defined(__x86_64__)
+    uint64_t result;
+    __asm__("pextq %2, %1, %0" : "=r"(result) : "r"(src), "rm"(mask));
+    return result;
+#else
+    uint64_t result = 0;
+    for (uint64_t bit = 1; mask; bit <<= 1, mask &= mask - 1) {
+        if (src & mask & (0 - mask)) result |= bit;
+    }
+    return result;
+#endif
+}
+
+constexpr Bitboard RowBB[8] = {
+    0xFFULL, 0xFFULL << 8, 0xFFULL << 16, 0xFFULL << 24,
+    0xFFULL << 32, 0xFFULL << 40, 0xFFULL << 48, 0xFFULL << 56
+};
+
+constexpr Bitboard ColABB = 0x0101010101010101ULL;
+constexpr Bitboard ColHBB = ColABB << 7;
+// Белые поля доски (a8 — белое поле).
+constexpr Bitboard LightSquaresBB = 0xAA55AA55AA55AA55ULL;
+
+namespace BitboardTables {
+
+// Таблица атак «прыгающих» фигур: смещения задаются парами (dRow, dCol).
+template <int N>
+constexpr std::array<Bitboard, 64> leaperTable(const int (&deltas)[N][2]) {
+    std::array<Bitboard, 64> table{};
+    for (int sq = 0; sq < 64; ++sq) {
+        for (int i = 0; i < N; ++i) {
+            int r = sq / 8 + deltas[i][0];
+            int c = sq % 8 + deltas[i][1];
+            if (r >= 0 && r < 8 && c >= 0 && c < 8) table[sq] |= Bitboard(1) << (r * 8 + c);
+        }
+    }
+    return table;
+}
+
+constexpr int KnightDeltas[8][2] = { {-2,-1}, {-2,1}, {-1,-2}, {-1,2}, {1,-2}, {1,2}, {2,-1}, {2,1} };
+constexpr int KingDeltas[8][2]   = { {-1,-1}, {-1,0}, {-1,1}, {0,-1}, {0,1}, {1,-1}, {1,0}, {1,1} };
+constexpr int WhitePawnDeltas[2][2] = { {-1,-1}, {-1,1} }; // Белые пешки идут к row 0.
+constexpr int BlackPawnDeltas[2][2] = { {1,-1}, {1,1} };
+
+// Лучи в восьми направлениях. Направления 0-3 увеличивают номер клетки, 4-7 уменьшают.
+constexpr int RayDeltas[8][2] = { {0,1}, {1,-1}, {1,0}, {1,1}, {0,-1}, {-1,1}, {-1,0}, {-1,-1} };
+
+constexpr std::array<std::array<Bitboard, 64>, 8> rayTable() {
+    std::array<std::array<Bitboard, 64>, 8> table{};
+    for (int dir = 0; dir < 8; ++dir) {
+        for (int sq = 0; sq < 64; ++sq) {
+            int r = sq / 8 + RayDeltas[dir][0];
+            int c = sq % 8 + RayDeltas[dir][1];
+            while (r >= 0 && r < 8 && c >= 0 && c < 8) {
+                table[dir][sq] |= Bitboard(1) << (r * 8 + c);
+                r += RayDeltas[dir][0];
+                c += RayDeltas[dir][1];
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<Bitboard, 64> Knight = leaperTable(KnightDeltas);
+inline constexpr std::array<Bitboard, 64> King = leaperTable(KingDeltas);
+inline constexpr std::array<Bitboard, 64> Pawn[3] = { {}, leaperTable(WhitePawnDeltas), leaperTable(BlackPawnDeltas) };
+inline constexpr std::array<std::array<Bitboard, 64>, 8> Rays = rayTable();
+
+// Для пар клеток на одной линии: Between — клетки строго между ними,
+// Line — вся линия от края до края через обе клетки. Для остальных пар — 0.
+constexpr std::array<std::array<Bitboard, 64>, 64> lineTable(bool between) {
+    std::array<std::array<Bitboard, 64>, 64> table{};
+    for (int from = 0; from < 64; ++from) {
+        for (int dir = 0; dir < 8; ++dir) {
+            Bitboard passed = 0;
+            int r = from / 8 + RayDeltas[dir][0];
+            int c = from % 8 + RayDeltas[dir][1];
+            while (r >= 0 && r < 8 && c >= 0 && c < 8) {
+                int to = r * 8 + c;
+                table[from][to] = between
+                    ? passed
+                    : (Rays[dir][from] | Rays[(dir + 4) % 8][from] | (Bitboard(1) << from));
+                passed |= Bitboard(1) << to;
+                r += RayDeltas[dir][0];
+                c += RayDeltas[dir][1];
+            }
+        }
+    }
+    return table;
+}
+
+inline constexpr std::array<std::array<Bitboard, 64>, 64> Between = lineTable(true);
+inline constexpr std::array<std::array<Bitboard, 64>, 64> Line = lineTable(false);
+
+// Атака вдоль одного луча с учетом первого блокирующего поля.
+// Используется только для заполнения таблиц дальнобойных фигур.
+inline Bitboard rayAttacks(int dir, int square, Bitboard occupied) {
+    Bitboard attacks = Rays[dir][square];
+    Bitboard blockers = attacks & occupied;
+    if (blockers) {
+        int blocker = (dir < 4) ? lsb(blockers) : msb(blockers);
+        attacks ^= Rays[dir][blocker];
+    }
+    return attacks;
+}
+
+// Использовать ли PEXT вместо магического умножения. Выбирается при запуске.
+extern bool UsePext;
+
+// Таблица атак дальнобойной фигуры с одной клетки. Индекс в attacks —
+// номер подмножества блокирующих фигур из mask: PEXT(occupied, mask)
+// или (occupied & mask) * magic >> shift («магические битборды»).
+struct Magic {
+    Bitboard mask;    // Клетки лучей без краев доски (фигуры на краю не блокируют).
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const {
+        if (UsePext) return static_cast<unsigned>(pext(occupied, mask));
+        return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+    }
+};
+
+extern Magic BishopMagics[64];
+extern Magic RookMagics[64];
+
+} // namespace BitboardTables
+
+// Заполняет таблицы атак слонов и ладей. Вызывается автоматически при запуске
+// программы; повторный вызов с allowPext = false переключает на магическое умножение
+// (например, для сравнения скорости).
+void initSlidingAttacks(bool allowPext = true);
+// Поддерживает ли процессор быструю инструкцию PEXT.
+bool cpuHasFastPext();
+// Векторные расширения x86 (с учетом поддержки ОС для AVX2) — для ядер оценки NNUE.
+bool cpuHasSse41();
+bool cpuHasAvx2();
+
+inline Bitboard knightAttacks(int square) { return BitboardTables::Knight[square]; }
+inline Bitboard kingAttacks(int square) { return BitboardTables::King[square]; }
+inline Bitboard pawnAttacks(PieceColor color, int square) { return BitboardTables::Pawn[color][square]; }
+inline Bitboard betweenBB(int from, int to) { return BitboardTables::Between[from][to]; }
+inline Bitboard lineBB(int from, int to) { return BitboardTables::Line[from][to]; }
+
+// Все поля, которые бьют пешки pawns цвета color (белые идут к row 0).
+inline Bitboard pawnAttacksBB(PieceColor color, Bitboard pawns) {
+    return (color == WHITE)
+        ? ((pawns & ~ColABB) >> 9) | ((pawns & ~ColHBB) >> 7)
+        : ((pawns & ~ColABB) << 7) | ((pawns & ~ColHBB) << 9);
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+    const BitboardTables::Magic& m = BitboardTables::BishopMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+    const BitboardTables::Magic& m = BitboardTables::RookMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(int square, Bitboard occupied) {
+    return bishopAttacks(square, occupied) | rookAttacks(square, occupied);
+}
+
+#endif // BITBOARD_H
@@ -0,0 +1,345 @@
+#include "movegen.h"
+#include "opening_book.h"
+#include "startpos.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+ * chess960-book — построение дебютной книги из PGN-архивов и просмотр книги.
+ *
+ *   chess960-book -o book.bin [--plies N] [--min-games N] FILE_OR_DIR...
+ *   chess960-book --probe book.bin [--sp N | --fen "<FEN>"]
+ *
+ * Из каждой партии берутся первые --plies полуходов (по умолчанию 24). Начальная
+ * позиция — из тега FEN; если его нет (как в партиях из history/), перебираются
+ * все 960 расстановок (сначала классическая) и берется та, в которой легальны все ходы.
+ * Ходы принимаются в SAN и в координатной записи ("e2-e4").
+ *
+ * Вес хода — очки, набранные с ним стороной, сделавшей ход, в полуочках
+ * (победа 2, ничья 1); незаконченная партия ("*") считается ничьей.
+ * Ходы, встретившиеся реже --min-games раз, в книгу не попадают.
+ */
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int DefaultBookPlies = 24;
+const int MaxProbeMoves = 64;
+
+struct PgnGame {
+    std::string fen;                 // Пусто — тега FEN нет.
+    std::string result;              // "1-0", "0-1", "1/2-1/2" или "*".
+    std::vector<std::string> moves;
+};
+
+// Одна встреча хода в партии, до слияния одинаковых.
+struct Occurrence {
+    uint64_t key;
+    PackedMove move;
+    uint8_t points;                  // В полуочках для стороны, сделавшей ход.
+};
+
+struct BuildStats {
+    int files = 0;
+    int games = 0;
+    int skippedGames = 0;
+    int inferredStarts = 0;
+};
+
+bool isResultToken(const std::string& token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+// Разбирает ходы партии: пропускает комментарии, варианты, NAG и номера ходов.
+void parseMovetext(const std::string& text, PgnGame& game) {
+    int variationDepth = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (c == '{') {
+            size_t end = text.find('}', i);
+            i = (end == std::string::npos) ? text.size() : end + 1;
+            continue;
+        }
+        if (c == ';') {
+            size_t end = text.find('\n', i);
+            i = (end == std::string::npos) ? text.size() : end + 1;
+            continue;
+        }
+        if (c == '(') { ++variationDepth; ++i; continue; }
+        if (c == ')') { variationDepth = std::max(0, variationDepth - 1); ++i; continue; }
+        if (std::isspace(static_cast<unsigned char>(c))) { ++i; continue; }
+
+        size_t end = i;
+        while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))
+               && text[end] != '{' && text[end] != '(' && text[end] != ')' && text[end] != ';') ++end;
+        std::string token = text.substr(i, end - i);
+        i = end;
+        if (variationDepth > 0 || token[0] == '$') continue;
+        if (isResultToken(token)) {
+            if (game.result.empty()) game.result = token;
+            continue;
+        }
+        // Номер хода может быть слит с ходом: "12.Nf3", "12...e5".
+        size_t moveStart = 0;
+        while (moveStart < token.size() && std::isdigit(static_cast<unsigned char>(token[moveStart]))) ++moveStart;
+        if (moveStart < token.size() && token[moveStart] == '.') {
+            while (moveStart < token.size() && token[moveStart] == '.') ++moveStart;
+        } else {
+            moveStart = 0;
+        }
+        if (moveStart < token.size()) game.moves.push_back(token.substr(moveStart));
+    }
+}
+
+// Все партии файла: теги [Name "Value"] и следующий за ними текст ходов.
+std::vector<PgnGame> readPgnFile(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<PgnGame> games;
+    std::string line, movetext;
+    PgnGame game;
+    bool inMovetext = false;
+
+    auto finishGame = [&]() {
+        parseMovetext(movetext, game);
+        if (!game.moves.empty()) games.push_back(game);
+        game = PgnGame();
+        movetext.clear();
+        inMovetext = false;
+    };
+
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty() && line[0] == '[') {
+            if (inMovetext) finishGame();
+            size_t nameEnd = line.find(' ');
+            size_t valueStart = line.find('"');
+            size_t valueEnd = line.rfind('"');
+            if (nameEnd == std::string::npos || valueStart == std::string::npos || valueEnd <= valueStart) continue;
+            std::string name = line.substr(1, nameEnd - 1);
+            std::string value = line.substr(valueStart + 1, valueEnd - valueStart - 1);
+            if (name == "FEN") game.fen = value;
+            else if (name == "Result") game.result = value;
+            continue;
+        }
+        if (line.find_first_not_of(" \t") == std::string::npos) continue;
+        inMovetext = true;
+        movetext += line;
+        movetext += '\n';
+    }
+    if (inMovetext) finishGame();
+    return games;
+}
+
+// Сколько первых ходов партии легальны из позиции start (но не больше limit).
+int countLegalPrefix(const Position& start, const std::vector<std::string>& moves, int limit) {
+    Position position = start;
+    int count = 0;
+    for (const std::string& text : moves) {
+        if (count == limit) break;
+        PackedMove move = parseMove(position, text);
+        if (move == NullMove) break;
+        UndoInfo undo;
+        position.makeMove(move, undo);
+        ++count;
+    }
+    return count;
+}
+
+// Начальная позиция партии без тега FEN: расстановка, в которой легальны все ходы
+// (проверяются все ходы партии, а не только книжные, — так расстановка определяется точнее).
+bool inferStartPosition(const PgnGame& game, Position& start) {
+    int total = static_cast<int>(game.moves.size());
+    for (int i = 0; i < Chess960PositionCount; ++i) {
+        // Классическая расстановка проверяется первой.
+        int spIndex = (i == 0) ? ClassicalStartPosition : (i <= ClassicalStartPosition ? i - 1 : i);
+        Position candidate;
+        setupStartPosition(candidate, spIndex);
+        if (countLegalPrefix(candidate, game.moves, total) == total) {
+            start = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+int whitePoints(const std::string& result) {
+    if (result == "1-0") return 2;
+    if (result == "0-1") return 0;
+    return 1;  // Ничья или незаконченная партия.
+}
+
+void addGame(const PgnGame& game, int plies, std::vector<Occurrence>& occurrences, BuildStats& stats) {
+    Position position;
+    if (!game.fen.empty()) {
+        if (!position.setFromFen(game.fen)) {
+            ++stats.skippedGames;
+            return;
+        }
+    } else if (!inferStartPosition(game, position)) {
+        ++stats.skippedGames;
+        return;
+    } else {
+        ++stats.inferredStarts;
+    }
+
+    int white = whitePoints(game.result);
+    for (int ply = 0; ply < plies && ply < static_cast<int>(game.moves.size()); ++ply) {
+        PackedMove move = parseMove(position, game.moves[ply]);
+        if (move == NullMove) break;  // Ошибка в записи: остаток партии не используется.
+        int points = (position.sideToMove() == WHITE) ? white : 2 - white;
+        occurrences.push_back({ position.key(), move, static_cast<uint8_t>(points) });
+        UndoInfo undo;
+        position.makeMove(move, undo);
+    }
+    ++stats.games;
+}
+
+void addPath(const fs::path& path, int plies, std::vector<Occurrence>& occurrences, BuildStats& stats) {
+    std::vector<fs::path> files;
+    std::error_code error;
+    if (fs::is_directory(path, error)) {
+        for (const auto& entry : fs::recursive_directory_iterator(path, error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".pgn") files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+    } else {
+        files.push_back(path);
+    }
+    for (const fs::path& file : files) {
+        for (const PgnGame& game : readPgnFile(file)) addGame(game, plies, occurrences, stats);
+        ++stats.files;
+    }
+}
+
+// Сливает одинаковые (позиция, ход), отбрасывает редкие и сортирует в порядке файла.
+std::vector<BookEntry> mergeOccurrences(std::vector<Occurrence>& occurrences, int minGames) {
+    std::sort(occurrences.begin(), occurrences.end(), [](const Occurrence& a, const Occurrence& b) {
+        return a.key != b.key ? a.key < b.key : a.move < b.move;
+    });
+    std::vector<BookEntry> entries;
+    for (size_t i = 0; i < occurrences.size(); ) {
+        size_t j = i;
+        uint64_t games = 0, points = 0;
+        for (; j < occurrences.size() && occurrences[j].key == occurrences[i].key && occurrences[j].move == occurrences[i].move; ++j) {
+            ++games;
+            points += occurrences[j].points;
+        }
+        if (games >= static_cast<uint64_t>(minGames)) {
+            BookEntry entry;
+            entry.key = occurrences[i].key;
+            entry.move = occurrences[i].move;
+            entry.games = static_cast<uint16_t>(std::min<uint64_t>(games, UINT16_MAX));
+            entry.points = static_cast<uint16_t>(std::min<uint64_t>(points, UINT16_MAX));
+            entry.weight = entry.points;
+            entries.push_back(entry);
+        }
+        i = j;
+    }
+    std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+        return a.key != b.key ? a.key < b.key : a.weight > b.weight;
+    });
+    return entries;
+}
+
+int runProbe(const std::string& bookPath, const Position& position) {
+    OpeningBook book;
+    std::string error;
+    auto openStart = std::chrono::steady_clock::now();
+    if (!book.open(bookPath, &error)) {
+        std::fprintf(stderr, "Cannot open book: %s\n", error.c_str());
+        return 2;
+    }
+    double openUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - openStart).count();
+
+    BookEntry entries[MaxProbeMoves];
+    auto probeStart = std::chrono::steady_clock::now();
+    int count = book.probe(position.key(), entries, MaxProbeMoves);
+    double probeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - probeStart).count();
+
+    std::printf("%s\n", position.fen().c_str());
+    uint32_t totalWeight = 0;
+    for (int i = 0; i < count; ++i) totalWeight += entries[i].weight;
+    for (int i = 0; i < count; ++i) {
+        std::printf("  %-6s weight %5u (%5.1f%%)  games %5u  score %5.1f%%\n",
+                    moveToString(entries[i].move).c_str(), entries[i].weight,
+                    totalWeight ? 100.0 * entries[i].weight / totalWeight : 0.0, entries[i].games,
+                    entries[i].games ? 50.0 * entries[i].points / entries[i].games : 0.0);
+    }
+    if (count == 0) std::printf("  not in book\n");
+    std::printf("Book: %zu entries  open %.1f us  probe %.1f us\n", book.size(), openUs, probeUs);
+    return 0;
+}
+
+void printUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s -o BOOK [--plies N] [--min-games N] FILE_OR_DIR...\n"
+                         "       %s --probe BOOK [--sp N | --fen FEN]\n", program, program);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output, probeBook, fen;
+    int plies = DefaultBookPlies;
+    int minGames = 1;
+    int spIndex = ClassicalStartPosition;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue) output = argv[++i];
+        else if (arg == "--plies" && hasValue) plies = std::atoi(argv[++i]);
+        else if (arg == "--min-games" && hasValue) minGames = std::atoi(argv[++i]);
+        else if (arg == "--probe" && hasValue) probeBook = argv[++i];
+        else if (arg == "--sp" && hasValue) spIndex = std::atoi(argv[++i]);
+        else if (arg == "--fen" && hasValue) fen = argv[++i];
+        else if (!arg.empty() && arg[0] != '-') inputs.push_back(arg);
+        else { printUsage(argv[0]); return 2; }
+    }
+
+    if (!probeBook.empty()) {
+        Position position;
+        if (!fen.empty()) {
+            if (!position.setFromFen(fen)) {
+                std::fprintf(stderr, "Invalid FEN: %s\n", fen.c_str());
+                return 2;
+            }
+        } else if (spIndex >= 0 && spIndex < Chess960PositionCount) {
+            setupStartPosition(position, spIndex);
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+        return runProbe(probeBook, position);
+    }
+
+    if (output.empty() || inputs.empty() || plies < 1 || minGames < 1) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Occurrence> occurrences;
+    BuildStats stats;
+    for (const std::string& input : inputs) addPath(input, plies, occurrences, stats);
+    std::vector<BookEntry> entries = mergeOccurrences(occurrences, minGames);
+
+    std::string error;
+    if (!OpeningBook::write(output, entries.data(), entries.size(), &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("Files %d  games %d (start position inferred for %d, skipped %d)  book entries %zu -> %s\n",
+                stats.files, stats.games, stats.inferredStarts, stats.skippedGames, entries.size(), output.c_str());
+    return 0;
+}
@@ -0,0 +1,15 @@
+# Консольная утилита bench: замер скорости движка (узлов в секунду)
+# поиском фиксированной глубины на постоянном наборе позиций. Не зависит от Qt:
+#   qmake chess960-bench.pro && make
+#   ./chess960-bench -d 7 --target-nps 1500000
+
+TEMPLATE = app
+TARGET = chess960-bench
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(chess960-core.pri)
+
+SOURCES += \
+    bench.cpp
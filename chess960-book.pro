@@ -0,0 +1,16 @@
+# Консольная утилита дебютной книги: построение из PGN-архивов и просмотр.
+# Не зависит от Qt:
+#   qmake chess960-book.pro && make
+#   ./chess960-book -o chess960.book history/
+#   ./chess960-book --probe chess960.book --sp 518
+
+TEMPLATE = app
+TARGET = chess960-book
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(chess960-core.pri)
+
+SOURCES += \
+    book.cpp
@@ -0,0 +1,43 @@
+# Ядро правил Chess960 (ChessGame, Position, генератор ходов, движок) на чистом C++17, без Qt.
+# Подключается в проекты через include(chess960-core.pri); отдельно собирается
+# статической библиотекой chess960-core.pro для консольных и серверных программ.
+
+INCLUDEPATH += $$PWD
+# Поиск движка многопоточный (std::thread).
+CONFIG += thread
+
+HEADERS += \
+    $$PWD/bitboard.h \
+    $$PWD/chess_game.h \
+    $$PWD/chess_types.h \
+    $$PWD/evaluate.h \
+    $$PWD/game_analysis.h \
+    $$PWD/game_hello.h \
+    $$PWD/mapped_file.h \
+    $$PWD/movegen.h \
+    $$PWD/nnue.h \
+    $$PWD/opening_book.h \
+    $$PWD/position.h \
+    $$PWD/psqt.h \
+    $$PWD/search.h \
+    $$PWD/search_stats.h \
+    $$PWD/startpos.h \
+    $$PWD/tablebase.h \
+    $$PWD/transposition_table.h \
+    $$PWD/zobrist.h
+SOURCES += \
+    $$PWD/bitboard.cpp \
+    $$PWD/chess_game.cpp \
+    $$PWD/evaluate.cpp \
+    $$PWD/game_analysis.cpp \
+    $$PWD/game_hello.cpp \
+    $$PWD/mapped_file.cpp \
+    $$PWD/movegen.cpp \
+    $$PWD/nnue.cpp \
+    $$PWD/opening_book.cpp \
+    $$PWD/position.cpp \
+    $$PWD/search.cpp \
+    $$PWD/search_stats.cpp \
+    $$PWD/startpos.cpp \
+    $$PWD/tablebase.cpp \
+    $$PWD/transposition_table.cpp
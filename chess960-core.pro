@@ -0,0 +1,11 @@
+# Статическая библиотека правил Chess960 без зависимости от Qt:
+#   qmake chess960-core.pro && make        -> libchess960-core.a
+# Подключение к своему проекту: INCLUDEPATH += <путь к исходникам>, LIBS += -lchess960-core.
+
+TEMPLATE = lib
+TARGET = chess960-core
+
+CONFIG += staticlib c++17
+CONFIG -= qt
+
+include(chess960-core.pri)
@@ -0,0 +1,15 @@
+# Консольная проверка приветствия сетевой игры (game_hello.h): кодирование и разбор.
+# Собирается отдельно от GUI и не зависит от Qt:
+#   qmake chess960-hello-check.pro && make
+#   ./chess960-hello-check
+
+TEMPLATE = app
+TARGET = chess960-hello-check
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(chess960-core.pri)
+
+SOURCES += \
+    hello_check.cpp
@@ -0,0 +1,15 @@
+# Консольная утилита perft: проверка и замер скорости генератора ходов.
+# Собирается отдельно от GUI и не зависит от Qt:
+#   qmake chess960-perft.pro && make
+#   ./chess960-perft -d 5 --sp 518
+
+TEMPLATE = app
+TARGET = chess960-perft
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(chess960-core.pri)
+
+SOURCES += \
+    perft.cpp
@@ -0,0 +1,16 @@
+# Консольная утилита таблиц эндшпиля: построение ретроградным анализом и просмотр.
+# Не зависит от Qt:
+#   qmake chess960-tbgen.pro && make
+#   ./chess960-tbgen -o tablebases --all 4
+#   ./chess960-tbgen --probe tablebases "8/8/8/4k3/8/8/8/KR6 w - - 0 1"
+
+TEMPLATE = app
+TARGET = chess960-tbgen
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(chess960-core.pri)
+
+SOURCES += \
+    tbgen.cpp
@@ -0,0 +1,15 @@
+# Матч движка с самим собой в несколько потоков: Эло, SPRT, партии в PGN.
+# Не зависит от Qt:
+#   qmake chess960-tournament.pro && make
+#   ./chess960-tournament -g 1000 --a nodes=40000 --b nodes=20000 -o games.pgn
+
+TEMPLATE = app
+TARGET = chess960-tournament
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(chess960-core.pri)
+
+SOURCES += \
+    tournament.cpp
@@ -0,0 +1,15 @@
+# Консольный движок по протоколу UCI (с UCI_Chess960) для оболочек турниров.
+# Не зависит от Qt:
+#   qmake chess960-uci.pro && make
+#   cutechess-cli -engine cmd=./chess960-uci proto=uci -variant fischerandom ...
+
+TEMPLATE = app
+TARGET = chess960-uci
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+include(chess960-core.pri)
+
+SOURCES += \
+    uci.cpp
@@ -0,0 +1,289 @@
+#include "chess_game.h"
+#include "tablebase.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+bool isWithinBoard(int r, int c) {
+    return r >= 0 && r < 8 && c >= 0 && c < 8;
+}
+}
+
+ChessGame::ChessGame()
+    : m_tablebaseAdjudication(false), m_tablebaseWinner(NO_COLOR), m_random(std::random_device{}()),
+      m_legalMovesKey(0), m_legalMovesValid(false) {
+    setupNewGame();
+}
+
+// Полный сброс и настройка новой игры.
+void ChessGame::setupNewGame(int spIndex) {
+    if (spIndex < 0 || spIndex >= Chess960PositionCount) {
+        spIndex = std::uniform_int_distribution<int>(0, Chess960PositionCount - 1)(m_random);
+    }
+    m_startPositionIndex = spIndex;
+    m_gameStatus = IN_PROGRESS;
+    m_whiteCaptured.clear();
+    m_blackCaptured.clear();
+    setupStartPosition(m_position, spIndex);
+    startHistory();
+    resetHistoryBrowser();
+    invalidateMoveCache();
+}
+
+// Новая игра из сетевого приветствия. Приветствие уже проверено при разборе
+// (decodeGameHello): по одному королю, пешки не на крайних горизонталях, права на
+// рокировку — только при короле и ладье на своих клетках, шаха не ходящему нет.
+void ChessGame::setupFromHello(const GameHello& hello)
+{
+    if (hello.spIndex >= 0) {
+        setupNewGame(hello.spIndex);
+        return;
+    }
+    m_whiteCaptured.clear();
+    m_blackCaptured.clear();
+    m_gameStatus = IN_PROGRESS;
+    m_position.clear();
+    for (int square = 0; square < 64; ++square) {
+        Piece piece = unpackPiece(hello.board[square]);
+        if (piece.type != NONE) m_position.putPiece(square, piece);
+    }
+    for (PieceColor color : { WHITE, BLACK }) {
+        m_position.setCastlingFiles(color, hello.kingCol[color], hello.rookCols[color][LONG_CASTLE],
+                                    hello.rookCols[color][SHORT_CASTLE]);
+        m_position.setCastlingRight(color, LONG_CASTLE, hello.castling[color][LONG_CASTLE]);
+        m_position.setCastlingRight(color, SHORT_CASTLE, hello.castling[color][SHORT_CASTLE]);
+    }
+    m_position.setSideToMove(hello.sideToMove);
+    PieceType backRank[8];
+    for (int col = 0; col < 8; ++col) backRank[col] = m_position.pieceAt(makeSquare(7, col)).type;
+    m_startPositionIndex = chess960PositionIndex(backRank);
+    m_position.updateAttackInfo();
+    startHistory();
+    resetHistoryBrowser();
+    invalidateMoveCache();
+}
+
+// Атомарно выполняет ход, включая рокировку и превращение.
+bool ChessGame::tryMove(const Move& requestedMove) {
+    if (m_gameStatus != IN_PROGRESS) return false;
+    PackedMove move;
+    if (!findLegalMove(requestedMove, move)) return false;
+
+    UndoInfo undo;
+    m_position.makeMove(move, undo);
+
+    if (undo.captured.type != NONE) {
+        (undo.captured.color == WHITE) ? m_whiteCaptured.push_back(undo.captured) : m_blackCaptured.push_back(undo.captured);
+    }
+    // Сохранение в историю.
+    recordMove(move, undo);
+    resetHistoryBrowser();
+
+    updateGameStatus();
+    return true;
+}
+
+// Отменяет последний ход (в том числе завершивший партию).
+bool ChessGame::undoMove() {
+    if (m_moves.empty()) return false;
+    const MoveDelta& delta = m_moves.back();
+    m_keyHistory.pop_back();
+    m_position.unmakeMove(delta, m_keyHistory.back());
+    Piece captured = unpackPiece(delta.captured);
+    if (captured.type != NONE) {
+        (captured.color == WHITE) ? m_whiteCaptured.pop_back() : m_blackCaptured.pop_back();
+    }
+    m_moves.pop_back();
+    // Контрольный снимок, сделанный после отмененного хода, больше не нужен.
+    if (m_checkpoints.size() > m_moves.size() / HistoryCheckpointInterval + 1) m_checkpoints.pop_back();
+
+    resetHistoryBrowser();
+    invalidateMoveCache();
+    updateGameStatus();
+    return true;
+}
+
+// Принудительно завершает игру (используется при дисконнекте).
+void ChessGame::forceEndGame()
+{
+    m_gameStatus = CHECKMATE; // Любой статус завершения, чтобы UI включил историю.
+}
+
+bool ChessGame::findLegalMove(const Move& requested, PackedMove& legalMove) {
+    if (!isWithinBoard(requested.fromRow, requested.fromCol) || !isWithinBoard(requested.toRow, requested.toCol)) return false;
+
+    // Ходы сравниваются в упакованном виде; без превращения запрос совпадет
+    // с обычным ходом, иначе — с ходом, превращающим в выбранную фигуру (по умолчанию ферзь).
+    PackedMove plain = packMove(makeSquare(requested.fromRow, requested.fromCol), makeSquare(requested.toRow, requested.toCol));
+    PackedMove promotion = packMove(moveFrom(plain), moveTo(plain), (requested.promotion == NONE) ? QUEEN : requested.promotion);
+    for (PackedMove move : legalMoves()) {
+        if (move != plain && move != promotion) continue;
+        legalMove = move;
+        return true;
+    }
+    return false;
+}
+
+// Проверяет, есть ли у стороны, которой ходить, хотя бы один легальный ход.
+bool ChessGame::hasLegalMoves() {
+    return !legalMoves().empty();
+}
+
+// Кеш действителен, пока его не сбросили и позиция (ее хеш) не изменилась.
+const MoveList& ChessGame::legalMoves() {
+    if (!m_legalMovesValid || m_legalMovesKey != m_position.key()) {
+        m_legalMoves.size = 0;
+        generateLegalMoves(m_position, m_legalMoves);
+        m_legalMovesKey = m_position.key();
+        m_legalMovesValid = true;
+    }
+    return m_legalMoves;
+}
+
+void ChessGame::invalidateMoveCache() {
+    m_legalMovesValid = false;
+}
+
+// Собирает ВСЕ легальные ходы для фигуры на (row, col).
+std::vector<Move> ChessGame::getValidMovesForPiece(int row, int col) {
+    std::vector<Move> validMoves;
+    if (!isWithinBoard(row, col)) return validMoves;
+
+    int from = makeSquare(row, col);
+    for (PackedMove move : legalMoves()) {
+        if (moveFrom(move) == from) validMoves.push_back(unpackMove(move));
+    }
+    return validMoves;
+}
+
+namespace {
+// Переносит ход из истории на доску из упакованных фигур (для просмотра истории).
+void applyDelta(std::array<PackedPiece, 64>& board, const MoveDelta& delta) {
+    int from = moveFrom(delta.move), to = moveTo(delta.move);
+    Piece moved = unpackPiece(delta.moved);
+    if (delta.isCastling) {
+        bool isShortCastle = squareCol(to) > squareCol(from);
+        PackedPiece rook = board[to];
+        board[from] = board[to] = 0;
+        board[makeSquare(squareRow(from), isShortCastle ? 6 : 2)] = delta.moved;
+        board[makeSquare(squareRow(from), isShortCastle ? 5 : 3)] = rook;
+        return;
+    }
+    if (delta.capturedSquare != -1) board[delta.capturedSquare] = 0;
+    board[from] = 0;
+    if (movePromotion(delta.move) != NONE && moved.type == PAWN) moved.type = movePromotion(delta.move);
+    board[to] = packPiece(moved);
+}
+}
+
+// Начинает историю с текущей позиции: она же первый контрольный снимок.
+void ChessGame::startHistory() {
+    m_moves.clear();
+    m_checkpoints.clear();
+    m_keyHistory.clear();
+    std::array<PackedPiece, 64> snapshot;
+    std::copy(m_position.board(), m_position.board() + 64, snapshot.begin());
+    m_checkpoints.push_back(snapshot);
+    m_keyHistory.push_back(m_position.key());
+}
+
+// Добавляет сделанный ход в историю; каждые HistoryCheckpointInterval полуходов — полный снимок доски.
+void ChessGame::recordMove(PackedMove move, const UndoInfo& undo) {
+    m_moves.emplace_back(move, undo);
+    m_keyHistory.push_back(m_position.key());
+    if (m_moves.size() % HistoryCheckpointInterval == 0) {
+        std::array<PackedPiece, 64> snapshot;
+        std::copy(m_position.board(), m_position.board() + 64, snapshot.begin());
+        m_checkpoints.push_back(snapshot);
+    }
+}
+
+// Текущая позиция встречалась не меньше трех раз. Сравниваются только позиции
+// с той же очередью хода и после последнего необратимого хода (взятия или хода пешкой).
+bool ChessGame::isThreefoldRepetition() const {
+    int last = static_cast<int>(m_keyHistory.size()) - 1;
+    int first = std::max(0, last - m_position.halfmoveClock());
+    int count = 1;
+    for (int i = last - 2; i >= first; i -= 2) {
+        if (m_keyHistory[i] == m_keyHistory[last] && ++count >= 3) return true;
+    }
+    return false;
+}
+
+// Позиция после index полуходов: ближайший контрольный снимок и ходы после него.
+const Piece* ChessGame::browseHistory(int step) {
+    int newIndex = m_historyBrowserIndex + step;
+    if (newIndex < 0 || newIndex >= getHistorySize()) return nullptr;
+    m_historyBrowserIndex = newIndex;
+
+    size_t checkpoint = newIndex / HistoryCheckpointInterval;
+    std::array<PackedPiece, 64> board = m_checkpoints[checkpoint];
+    for (size_t ply = checkpoint * HistoryCheckpointInterval; ply < static_cast<size_t>(newIndex); ++ply) {
+        applyDelta(board, m_moves[ply]);
+    }
+    for (int square = 0; square < 64; ++square) m_historyView[square] = unpackPiece(board[square]);
+    return m_historyView.data();
+}
+
+// Полные позиции восстанавливаются отменой ходов от текущей.
+std::vector<Position> ChessGame::historyPositions() const {
+    std::vector<Position> positions(m_moves.size() + 1);
+    Position position = m_position;
+    positions.back() = position;
+    for (size_t ply = m_moves.size(); ply-- > 0; ) {
+        position.unmakeMove(m_moves[ply], m_keyHistory[ply]);
+        positions[ply] = position;
+    }
+    return positions;
+}
+
+void ChessGame::resetHistoryBrowser() {
+    m_historyBrowserIndex = getHistorySize() - 1;
+}
+int ChessGame::getHistorySize() const { return static_cast<int>(m_moves.size()) + 1; }
+int ChessGame::getCurrentHistoryIndex() const { return m_historyBrowserIndex; }
+void ChessGame::updateGameStatus() {
+    if (!hasLegalMoves()) {
+        m_gameStatus = m_position.isKingInCheck(m_position.sideToMove()) ? CHECKMATE : STALEMATE;
+    } else if (m_position.isInsufficientMaterial()) {
+        m_gameStatus = DRAW_INSUFFICIENT_MATERIAL;
+    } else if (m_position.halfmoveClock() >= 100) {
+        m_gameStatus = DRAW_FIFTY_MOVES;
+    } else if (isThreefoldRepetition()) {
+        m_gameStatus = DRAW_REPETITION;
+    } else {
+        m_gameStatus = IN_PROGRESS;
+        adjudicateByTablebase();
+    }
+}
+void ChessGame::adjudicateByTablebase() {
+    Tablebase::ProbeResult result;
+    if (!m_tablebaseAdjudication || !Tablebase::probe(m_position, result)) return;
+    if (result.wdl == Tablebase::WDL_DRAW) {
+        m_gameStatus = TABLEBASE_DRAW;
+        m_tablebaseWinner = NO_COLOR;
+        return;
+    }
+    // Таблицы не знают правила 50 ходов: выигрыш, который не успеть реализовать, не присуждается.
+    if (m_position.halfmoveClock() + result.dtz > 100) return;
+    m_gameStatus = TABLEBASE_WIN;
+    m_tablebaseWinner = result.wdl == Tablebase::WDL_WIN ? m_position.sideToMove() : oppositeColor(m_position.sideToMove());
+}
+void ChessGame::setTablebaseAdjudication(bool enabled) {
+    m_tablebaseAdjudication = enabled;
+    if (m_gameStatus == IN_PROGRESS) adjudicateByTablebase();
+}
+PieceColor ChessGame::getWinner() const {
+    if (m_gameStatus == CHECKMATE) return oppositeColor(m_position.sideToMove());
+    return m_gameStatus == TABLEBASE_WIN ? m_tablebaseWinner : NO_COLOR;
+}
+bool ChessGame::isKingInCheck(PieceColor kingColor) const { return m_position.isKingInCheck(kingColor); }
+std::pair<int, int> ChessGame::getKingPosition(PieceColor kingColor) const {
+    int square = m_position.kingSquare(kingColor);
+    return (square == -1) ? std::make_pair(-1, -1) : std::make_pair(squareRow(square), squareCol(square));
+}
+Piece ChessGame::getPieceAt(int row, int col) const { return m_position.pieceAt(makeSquare(row, col)); }
+PieceColor ChessGame::getCurrentTurn() const { return m_position.sideToMove(); }
+GameStatus ChessGame::getGameStatus() const { return m_gameStatus; }
+int ChessGame::getStartPositionIndex() const { return m_startPositionIndex; }
+const std::vector<Piece>& ChessGame::getCapturedPieces(PieceColor color) const { return (color == WHITE) ? m_whiteCaptured : m_blackCaptured; }
@@ -0,0 +1,111 @@
+#ifndef CHESS_GAME_H
+#define CHESS_GAME_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "chess_types.h"
+#include "position.h"
+#include "movegen.h"
+#include "startpos.h"
+#include "game_hello.h"
+
+/**
+ * @class ChessGame
+ * @brief Партия Chess960 по правилам: ядро без Qt.
+ *
+ * Управляет состоянием доски, проверяет корректность ходов по правилам
+ * Chess960, определяет исход игры и хранит историю партии. Не зависит от Qt
+ * и собирается в статическую библиотеку chess960-core (см. chess960-core.pro),
+ * поэтому используется и в GUI (через адаптер PieceLogic), и в консольных утилитах.
+ *
+ * Легальные ходы текущей позиции генерируются один раз и кешируются (по хешу позиции):
+ * из кеша отвечают getValidMovesForPiece, проверка хода в tryMove и определение
+ * мата/пата. Адаптер сбрасывает кеш по сигналу boardChanged (invalidateMoveCache).
+ */
+class ChessGame
+{
+public:
+    ChessGame();
+
+    // --- Основной API для управления игрой ---
+    void setupNewGame(int spIndex = -1);    // Новая игра с позицией по номеру Шарнагля (-1 — случайная).
+    bool tryMove(const Move& move);         // Пытается выполнить ход.
+    bool undoMove();                        // Отменяет последний ход; false, если ходов не было.
+    // Новая игра из сетевого приветствия (см. game_hello.h): по номеру позиции
+    // или по переданной доске с исходными вертикалями рокировки.
+    void setupFromHello(const GameHello& hello);
+    void forceEndGame();                    // Принудительно завершает игру (для дисконнекта).
+    void invalidateMoveCache();
+    // Завершать партию, как только позиция есть в загруженных таблицах эндшпиля
+    // (см. tablebase.h): TABLEBASE_WIN или TABLEBASE_DRAW. По умолчанию выключено.
+    void setTablebaseAdjudication(bool enabled);
+
+    // --- Методы для получения состояния игры ---
+    Piece getPieceAt(int row, int col) const;
+    PieceColor getCurrentTurn() const;
+    GameStatus getGameStatus() const;
+    PieceColor getWinner() const;           // Победитель (мат или таблицы); NO_COLOR — ничья или игра идет.
+    int getStartPositionIndex() const;      // Номер Шарнагля стартовой позиции или -1, если неизвестен.
+    const std::vector<Piece>& getCapturedPieces(PieceColor color) const;
+    std::vector<Move> getValidMovesForPiece(int row, int col);
+    bool isKingInCheck(PieceColor kingColor) const;
+    std::pair<int, int> getKingPosition(PieceColor kingColor) const; // {-1, -1}, если короля нет.
+    const Position& position() const { return m_position; }
+    const std::vector<uint64_t>& keyHistory() const { return m_keyHistory; } // Хеши всех позиций партии.
+
+    // --- Методы для просмотра истории ---
+    // Позиции пронумерованы от 0 (стартовая) до getHistorySize() - 1 (текущая).
+    const Piece* browseHistory(int step);
+    void resetHistoryBrowser();
+    int getHistorySize() const;
+    int getCurrentHistoryIndex() const;
+    const std::vector<MoveDelta>& moves() const { return m_moves; }
+    // Все позиции партии (индексы как у browseHistory): для анализа движком.
+    std::vector<Position> historyPositions() const;
+
+    // Через сколько полуходов история сохраняет полный снимок доски.
+    static const int HistoryCheckpointInterval = 16;
+
+private:
+    // --- Внутреннее состояние игры ---
+    Position m_position;                    // Расстановка (битборды), очередь хода, рокировка, взятие на проходе.
+    GameStatus m_gameStatus;
+    bool m_tablebaseAdjudication;
+    PieceColor m_tablebaseWinner;
+    int m_startPositionIndex;
+    std::vector<Piece> m_whiteCaptured;
+    std::vector<Piece> m_blackCaptured;
+    std::mt19937 m_random;
+
+    // --- История ---
+    // Стек сжатых ходов (10 байт на полуход) и полные снимки доски
+    // после каждых HistoryCheckpointInterval полуходов для быстрого доступа к любой позиции.
+    std::vector<MoveDelta> m_moves;
+    std::vector<std::array<PackedPiece, 64>> m_checkpoints;
+    std::array<Piece, 64> m_historyView;    // Развернутая позиция, которую отдает browseHistory.
+    int m_historyBrowserIndex;
+    std::vector<uint64_t> m_keyHistory;     // Хеши Зобриста всех позиций партии (для повторений).
+
+    // --- Кеш легальных ходов текущей позиции ---
+    MoveList m_legalMoves;
+    uint64_t m_legalMovesKey;
+    bool m_legalMovesValid;
+
+    // --- Приватные вспомогательные функции ---
+    const MoveList& legalMoves();           // Легальные ходы текущей позиции (из кеша).
+    void updateGameStatus();
+    void adjudicateByTablebase();           // Проверка позиции по таблицам эндшпиля (в updateGameStatus).
+    bool hasLegalMoves();
+    bool isThreefoldRepetition() const;
+    void startHistory();
+    void recordMove(PackedMove move, const UndoInfo& undo);
+
+    // Ищет среди легальных ходов запрошенный (для превращения по умолчанию — ферзь).
+    bool findLegalMove(const Move& requested, PackedMove& legalMove);
+};
+
+#endif // CHESS_GAME_H
@@ -0,0 +1,63 @@
+#ifndef CHESS_TYPES_H
+#define CHESS_TYPES_H
+
+#include <cstdint>
+
+// Перечисления для типов фигур, цвета и статуса игры.
+enum PieceType { NONE, KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN };
+enum PieceColor { NO_COLOR, WHITE, BLACK };
+enum GameStatus {
+    IN_PROGRESS, CHECKMATE, STALEMATE,
+    DRAW_REPETITION,            // Троекратное повторение позиции.
+    DRAW_FIFTY_MOVES,           // 50 ходов без взятий и ходов пешкой.
+    DRAW_INSUFFICIENT_MATERIAL, // Ни одна сторона не может поставить мат.
+    TABLEBASE_WIN,              // Исход решен таблицами эндшпиля: выигрыш (победитель — ChessGame::getWinner)
+    TABLEBASE_DRAW              // или ничья при лучшей игре.
+};
+
+// Структура, представляющая одну фигуру на доске.
+struct Piece {
+    PieceType type = NONE;
+    PieceColor color = NO_COLOR;
+};
+
+// Структура, представляющая один ход. Включает поле для превращения пешки.
+// Рокировка кодируется как ход короля на клетку своей ладьи.
+struct Move {
+    int fromRow, fromCol;
+    int toRow, toCol;
+    PieceType promotion = NONE;
+};
+
+inline PieceColor oppositeColor(PieceColor color) { return (color == WHITE) ? BLACK : WHITE; }
+
+// Упакованная фигура (1 байт): младший полубайт — тип, старший — цвет.
+// Доска из 64 таких фигур занимает одну кеш-линию.
+typedef uint8_t PackedPiece;
+
+inline PackedPiece packPiece(Piece piece) { return static_cast<PackedPiece>(piece.type | (piece.color << 4)); }
+inline Piece unpackPiece(PackedPiece packed) {
+    return {static_cast<PieceType>(packed & 0xF), static_cast<PieceColor>(packed >> 4)};
+}
+
+// Упакованный ход (16 бит): биты 0-5 — клетка «откуда», 6-11 — клетка «куда»
+// (клетка = row * 8 + col), 12-14 — фигура превращения (NONE, если его нет).
+// Им пользуются генератор ходов, Position и сеть; Move — развернутое представление для UI.
+typedef uint16_t PackedMove;
+const PackedMove NullMove = 0; // a8-a8: не бывает настоящим ходом.
+
+inline PackedMove packMove(int from, int to, PieceType promotion = NONE) {
+    return static_cast<PackedMove>(from | (to << 6) | (promotion << 12));
+}
+inline int moveFrom(PackedMove move) { return move & 63; }
+inline int moveTo(PackedMove move) { return (move >> 6) & 63; }
+inline PieceType movePromotion(PackedMove move) { return static_cast<PieceType>((move >> 12) & 7); }
+
+inline PackedMove packMove(const Move& move) {
+    return packMove(move.fromRow * 8 + move.fromCol, move.toRow * 8 + move.toCol, move.promotion);
+}
+inline Move unpackMove(PackedMove move) {
+    return {moveFrom(move) >> 3, moveFrom(move) & 7, moveTo(move) >> 3, moveTo(move) & 7, movePromotion(move)};
+}
+
+#endif // CHESS_TYPES_H
@@ -0,0 +1,67 @@
+#include "engineworker.h"
+#include <QMetaType>
+#include <QStringList>
+
+EngineWorker::EngineWorker(QObject *parent)
+    : QObject(parent), m_searching(false)
+{
+    // Для доставки сигналов в поток окна (отложенное соединение).
+    qRegisterMetaType<PackedMove>("PackedMove");
+    qRegisterMetaType<SearchStats>("SearchStats");
+}
+
+EngineWorker::~EngineWorker()
+{
+    join();
+}
+
+int EngineWorker::start(const Position& root, const SearchLimits& limits, const std::vector<uint64_t>& keyHistory)
+{
+    join();
+    int searchId = ++m_lastSearchId;
+    m_search.setProgressCallback([this, searchId](const SearchResult& iteration) {
+        QStringList pv;
+        for (PackedMove move : iteration.pv) pv << QString::fromStdString(moveToString(move));
+        quint64 nps = iteration.seconds > 0 ? static_cast<quint64>(iteration.nodes / iteration.seconds) : 0;
+        emit progress(searchId, iteration.depth, iteration.score, iteration.nodes, nps, pv.join(' '));
+        emit statistics(searchId, iteration.stats);
+    });
+
+    m_searching = true;
+    // Флаги поиска сбрасываются здесь, а не в потоке: stop() и ponderHit(), вызванные
+    // до того, как поток дойдет до think, не теряются.
+    m_search.arm(limits);
+    // Позиция и история копируются: поток не зависит от того, что окно делает дальше.
+    m_thread = std::thread([this, searchId, root, limits, keyHistory]() {
+        SearchResult result = m_search.think(root, limits, keyHistory);
+        PackedMove ponderMove = result.pv.size() > 1 ? result.pv[1] : NullMove;
+        m_searching = false;
+        emit statistics(searchId, result.stats);
+        emit bestMoveFound(searchId, result.bestMove, ponderMove);
+    });
+    return searchId;
+}
+
+void EngineWorker::stop()
+{
+    m_search.stop();
+}
+
+void EngineWorker::ponderHit()
+{
+    m_search.ponderHit();
+}
+
+void EngineWorker::setThreads(int count)
+{
+    join();
+    m_search.setThreads(count);
+}
+
+// Останавливает текущий поиск и ждет его потока (остановка занимает доли миллисекунды).
+void EngineWorker::join()
+{
+    if (!m_thread.joinable()) return;
+    m_search.stop();
+    m_thread.join();
+}
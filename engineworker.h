@@ -0,0 +1,63 @@
+#ifndef ENGINEWORKER_H
+#define ENGINEWORKER_H
+
+#include "search.h"
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <thread>
+
+/**
+ * @class EngineWorker
+ * @brief Асинхронный движок для интерфейса: поиск идет в отдельном потоке,
+ *        окно узнает о ходе поиска и его результате из сигналов и не блокируется.
+ *
+ * Каждый поиск получает номер (start возвращает его), и все сигналы несут этот номер:
+ * результаты прерванного или отмененного поиска окно узнает и отбрасывает.
+ * Поддерживается обдумывание на ходу соперника: start с limits.ponder ищет
+ * позицию после ожидаемого ответа, пока не будет вызван ponderHit() (соперник сходил
+ * так, как ожидалось) или stop()/новый start() (не угадали).
+ *
+ * Сигналы испускаются из потока поиска и доставляются получателю в его потоке
+ * (соединение по умолчанию становится отложенным).
+ */
+class EngineWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EngineWorker(QObject *parent = nullptr);
+    // Останавливает поиск и дожидается потока.
+    ~EngineWorker() override;
+
+    // Начинает поиск, прерывая предыдущий; возвращает номер поиска.
+    int start(const Position& root, const SearchLimits& limits, const std::vector<uint64_t>& keyHistory);
+    // Просит поиск закончиться; bestMoveFound придет с лучшим ходом последней итерации.
+    void stop();
+    void ponderHit();
+    bool isSearching() const { return m_searching; }
+
+    // Число потоков поиска; текущий поиск при этом прерывается.
+    void setThreads(int count);
+    // Счетчики текущего поиска по всем потокам; без блокировок, для опроса по таймеру.
+    SearchStats stats() const { return m_search.stats(); }
+
+signals:
+    // Завершена очередная итерация: глубина, оценка (в сотых пешки, со стороны ходящего),
+    // узлы, скорость в узлах в секунду и главный вариант ("e2e4 e7e5 ...").
+    void progress(int searchId, int depth, int score, quint64 nodes, quint64 nps, const QString& pv);
+    // Статистика поиска после каждой итерации и в конце (с временем итераций).
+    void statistics(int searchId, const SearchStats& stats);
+    // Поиск закончен; ponderMove — ожидаемый ответ соперника (NullMove, если неизвестен).
+    void bestMoveFound(int searchId, PackedMove move, PackedMove ponderMove);
+
+private:
+    void join();
+
+    Search m_search;
+    std::thread m_thread;
+    std::atomic<bool> m_searching;
+    int m_lastSearchId = 0;
+};
+
+#endif // ENGINEWORKER_H
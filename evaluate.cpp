@@ -0,0 +1,63 @@
+#include "evaluate.h"
+#include <algorithm>
+
+namespace {
+
+// Вес одной доступной клетки по типу фигуры и среднее число клеток, от которого он отсчитывается.
+constexpr EvalScore MobilityWeight[7] = { {}, {}, { 1, 2 }, { 2, 4 }, { 4, 5 }, { 4, 4 }, {} };
+constexpr int MobilityBaseline[7] = { 0, 0, 13, 7, 6, 4, 0 };
+
+// Подвижность легких и тяжелых фигур стороны: клетки под ударом, не занятые
+// своими фигурами и не атакованные пешками соперника.
+EvalScore mobility(const Position& position, PieceColor color) {
+    PieceColor them = oppositeColor(color);
+    Bitboard theirPawns = position.pieces(them, PAWN);
+    Bitboard pawnAttacked = 0;
+    while (theirPawns) pawnAttacked |= pawnAttacks(them, popLsb(theirPawns));
+    Bitboard available = ~position.pieces(color) & ~pawnAttacked;
+    Bitboard occupied = position.occupied();
+
+    EvalScore score;
+    for (int type = QUEEN; type <= KNIGHT; ++type) {
+        Bitboard pieces = position.pieces(color, static_cast<PieceType>(type));
+        while (pieces) {
+            int square = popLsb(pieces);
+            int count = popCount(Position::attacksFrom({static_cast<PieceType>(type), color}, square, occupied) & available);
+            score += MobilityWeight[type] * (count - MobilityBaseline[type]);
+        }
+    }
+    return score;
+}
+
+int taper(EvalScore score, int phase) {
+    phase = std::min(phase, Psqt::MaxPhase);
+    return (score.mg * phase + score.eg * (Psqt::MaxPhase - phase)) / Psqt::MaxPhase;
+}
+
+} // namespace
+
+int evaluate(const Position& position) {
+    EvalScore score = position.psqScore() + mobility(position, WHITE) - mobility(position, BLACK);
+    int value = taper(score, position.gamePhase());
+    return (position.sideToMove() == WHITE) ? value : -value;
+}
+
+EvalBreakdown evaluateBreakdown(const Position& position) {
+    EvalBreakdown breakdown;
+    int phase = 0;
+    for (int square = 0; square < 64; ++square) {
+        Piece piece = position.pieceAt(square);
+        if (piece.type == NONE) continue;
+        int sign = (piece.color == WHITE) ? 1 : -1;
+        int tableSquare = (piece.color == WHITE) ? square : (square ^ 56);
+        breakdown.material += Psqt::Material[piece.type] * sign;
+        breakdown.pieceSquare += Psqt::pieceSquareBonus(piece.type, tableSquare) * sign;
+        phase += Psqt::PiecePhase[piece.type];
+    }
+    breakdown.mobility = mobility(position, WHITE) - mobility(position, BLACK);
+    breakdown.phase = std::min(phase, Psqt::MaxPhase);
+    breakdown.total = taper(breakdown.material + breakdown.pieceSquare + breakdown.mobility, phase);
+    breakdown.incrementalMatches = position.psqScore() == breakdown.material + breakdown.pieceSquare
+                                   && position.gamePhase() == phase;
+    return breakdown;
+}
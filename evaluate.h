@@ -0,0 +1,28 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "position.h"
+#include "psqt.h"
+
+// Стоимость фигур в сотых пешки для сортировки взятий; индекс — PieceType (король не оценивается).
+constexpr int PieceValue[7] = { 0, 0, 900, 500, 330, 320, 100 };
+
+// Статическая оценка позиции в сотых пешки с точки зрения стороны, которой ходить.
+// Плавно переходит от миттельшпиля к эндшпилю по стадии партии: материал
+// и позиционные таблицы (поддерживаются Position инкрементально) плюс подвижность фигур.
+int evaluate(const Position& position);
+
+// Оценка по слагаемым для отладки; все части — с точки зрения белых.
+struct EvalBreakdown {
+    EvalScore material;
+    EvalScore pieceSquare;
+    EvalScore mobility;
+    int phase = 0;              // 0 (эндшпиль) .. Psqt::MaxPhase (миттельшпиль).
+    int total = 0;              // Итог после смешивания, с точки зрения белых.
+    bool incrementalMatches = true; // Совпал ли пересчет материала и таблиц с инкрементальным.
+};
+
+// Пересчитывает все слагаемые с нуля (медленно; только для отладки и тестов).
+EvalBreakdown evaluateBreakdown(const Position& position);
+
+#endif // EVALUATE_H
@@ -0,0 +1,108 @@
+#include "game_analysis.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Оценки выше этой (решающий перевес, мат) для качества хода равноценны:
+// ход из +15 в мат в 20 ошибкой не считается.
+const int ScoreCap = 1000;
+
+// Ничья по правилам: недостаточно материала, 50 ходов или третье повторение.
+bool isDrawnByRule(const Position& position, const std::vector<uint64_t>& keys, int ply) {
+    if (position.isInsufficientMaterial() || position.halfmoveClock() >= 100) return true;
+    int first = std::max(0, ply - position.halfmoveClock());
+    int count = 1;
+    for (int i = ply - 2; i >= first; i -= 2) {
+        if (keys[i] == keys[ply] && ++count >= 3) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+MoveQuality classifyMove(const PositionAnalysis& before, const PositionAnalysis& after, PackedMove move) {
+    int sign = before.sideToMove == WHITE ? 1 : -1;
+    int best = before.lines.empty() ? sign * before.score : before.lines.front().score;
+    int played = sign * after.score;
+    for (const SearchLine& line : before.lines) {
+        if (!line.pv.empty() && line.pv.front() == move) {
+            played = line.score;
+            break;
+        }
+    }
+    int loss = std::clamp(best, -ScoreCap, ScoreCap) - std::clamp(played, -ScoreCap, ScoreCap);
+    if (loss >= BlunderThreshold) return MOVE_BLUNDER;
+    if (loss >= MistakeThreshold) return MOVE_MISTAKE;
+    return MOVE_GOOD;
+}
+
+void GameAnalysis::start(const std::vector<Position>& positions, const std::vector<uint64_t>& keys,
+                         const SearchLimits& limits, int threads, size_t hashMbPerThread, Callback callback) {
+    stop();
+    m_positions = positions;
+    m_keys = keys;
+    m_limits = limits;
+    m_limits.ponder = false;
+    m_callback = std::move(callback);
+    m_next = 0;
+    m_stop = false;
+
+    threads = std::max(1, std::min(threads, static_cast<int>(positions.size())));
+    m_searches.clear();
+    for (int i = 0; i < threads; ++i) {
+        m_searches.emplace_back(new Search());
+        m_searches.back()->setHashSizeMb(hashMbPerThread);
+    }
+    m_active = threads;
+    for (int i = 0; i < threads; ++i) {
+        Search* search = m_searches[i].get();
+        m_threads.emplace_back([this, search]() { work(*search); });
+    }
+}
+
+void GameAnalysis::stop() {
+    m_stop = true;
+    // Поток мог взять позицию уже после первого stop() своего поиска: повторяем, пока все не выйдут.
+    while (m_active > 0) {
+        for (auto& search : m_searches) search->stop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (std::thread& thread : m_threads) thread.join();
+    m_threads.clear();
+}
+
+void GameAnalysis::work(Search& search) {
+    for (;;) {
+        int ply = m_next.fetch_add(1);
+        if (ply >= static_cast<int>(m_positions.size()) || m_stop) break;
+        PositionAnalysis analysis = analyse(search, ply);
+        if (m_stop) break;
+        m_callback(analysis);
+    }
+    --m_active;
+}
+
+PositionAnalysis GameAnalysis::analyse(Search& search, int ply) {
+    const Position& position = m_positions[ply];
+    PositionAnalysis analysis;
+    analysis.ply = ply;
+    analysis.sideToMove = position.sideToMove();
+    int sign = analysis.sideToMove == WHITE ? 1 : -1;
+
+    MoveList legal;
+    generateLegalMoves(position, legal);
+    if (legal.empty()) {
+        analysis.score = position.checkers() ? -sign * MateScore : 0;
+        return analysis;
+    }
+    if (isDrawnByRule(position, m_keys, ply)) return analysis;
+
+    std::vector<uint64_t> keys(m_keys.begin(), m_keys.begin() + ply + 1);
+    SearchResult result = search.think(position, m_limits, keys);
+    analysis.score = sign * result.score;
+    analysis.depth = result.depth;
+    analysis.lines = result.lines;
+    if (analysis.lines.empty()) analysis.lines.push_back(SearchLine{ result.score, result.pv });
+    return analysis;
+}
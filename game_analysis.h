@@ -0,0 +1,71 @@
+#ifndef GAME_ANALYSIS_H
+#define GAME_ANALYSIS_H
+
+#include "search.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Оценка одной позиции партии.
+struct PositionAnalysis {
+    int ply = -1;                   // Номер позиции (0 — стартовая); -1 — еще не оценена.
+    PieceColor sideToMove = WHITE;
+    int score = 0;                  // С точки зрения белых; мат — как в поиске (±(MateScore - n)).
+    int depth = 0;                  // 0 — позиция конечная (мат, пат, ничья по правилам).
+    std::vector<SearchLine> lines;  // Лучшие варианты со стороны ходящего, по убыванию оценки.
+};
+
+enum MoveQuality { MOVE_GOOD, MOVE_MISTAKE, MOVE_BLUNDER };
+
+// Потеря оценки ходом (в сотых пешки, со стороны сходившего), начиная с которой ход — ошибка / зевок.
+const int MistakeThreshold = 100;
+const int BlunderThreshold = 300;
+
+// Качество хода move, сделанного из позиции before и приведшего к позиции after.
+// Если ход есть среди вариантов before, берется его оценка из того же поиска.
+MoveQuality classifyMove(const PositionAnalysis& before, const PositionAnalysis& after, PackedMove move);
+
+/**
+ * @class GameAnalysis
+ * @brief Анализ всей партии в пуле потоков: по позиции на поток.
+ *
+ * Каждый поток берет очередную позицию из общего счетчика и ищет ее своим
+ * однопоточным Search (multi-PV, фиксированное время), так что партия из N полуходов
+ * анализируется примерно за время одной позиции x N / число потоков. Результат
+ * каждой позиции сразу передается в callback — из потока анализа, в порядке готовности.
+ * Не зависит от Qt.
+ */
+class GameAnalysis
+{
+public:
+    using Callback = std::function<void(const PositionAnalysis&)>;
+
+    GameAnalysis() : m_next(0), m_stop(false), m_active(0) {}
+    ~GameAnalysis() { stop(); }
+
+    // positions[i] — позиция после i полуходов; keys — хеши тех же позиций (для повторений).
+    // Предыдущий анализ прерывается.
+    void start(const std::vector<Position>& positions, const std::vector<uint64_t>& keys,
+               const SearchLimits& limits, int threads, size_t hashMbPerThread, Callback callback);
+    // Прерывает анализ и дожидается потоков; callback больше не вызывается.
+    void stop();
+    bool isRunning() const { return m_active > 0; }
+
+private:
+    void work(Search& search);
+    PositionAnalysis analyse(Search& search, int ply);
+
+    std::vector<Position> m_positions;
+    std::vector<uint64_t> m_keys;
+    SearchLimits m_limits;
+    Callback m_callback;
+    std::vector<std::unique_ptr<Search>> m_searches;
+    std::vector<std::thread> m_threads;
+    std::atomic<int> m_next;
+    std::atomic<bool> m_stop;
+    std::atomic<int> m_active;
+};
+
+#endif // GAME_ANALYSIS_H
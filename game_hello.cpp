@@ -0,0 +1,131 @@
+#include "game_hello.h"
+#include "startpos.h"
+#include <cstring>
+
+namespace {
+
+const uint8_t FlagBoard = 1;
+const uint8_t NoFile = 0xFF;
+
+uint8_t encodeFile(int col) { return col < 0 ? NoFile : static_cast<uint8_t>(col); }
+
+bool decodeFile(uint8_t value, int& col) {
+    if (value == NoFile) col = -1;
+    else if (value < 8) col = value;
+    else return false;
+    return true;
+}
+
+bool isPlayerColor(uint8_t value) { return value == WHITE || value == BLACK; }
+
+} // namespace
+
+GameHello makeGameHello(const Position& position, int spIndex, PieceColor receiverColor) {
+    GameHello hello;
+    hello.receiverColor = receiverColor;
+    hello.spIndex = spIndex;
+    if (spIndex >= 0) return hello;
+
+    for (int square = 0; square < 64; ++square) hello.board[square] = packPiece(position.pieceAt(square));
+    for (PieceColor color : { WHITE, BLACK }) {
+        hello.kingCol[color] = position.kingInitialCol(color);
+        for (int side : { LONG_CASTLE, SHORT_CASTLE }) {
+            hello.rookCols[color][side] = position.rookInitialCol(color, side);
+            hello.castling[color][side] = position.canCastle(color, side);
+        }
+    }
+    hello.sideToMove = position.sideToMove();
+    return hello;
+}
+
+void encodeGameHello(const GameHello& hello, uint8_t out[HelloSize]) {
+    std::memset(out, 0, HelloSize);
+    out[0] = HelloVersion;
+    out[2] = static_cast<uint8_t>(hello.receiverColor);
+    if (hello.spIndex >= 0) {
+        out[3] = static_cast<uint8_t>(hello.spIndex >> 8);
+        out[4] = static_cast<uint8_t>(hello.spIndex);
+        return;
+    }
+
+    out[1] = FlagBoard;
+    out[3] = out[4] = 0xFF;
+    for (int square = 0; square < 64; ++square) {
+        Piece piece = unpackPiece(hello.board[square]);
+        uint8_t nibble = piece.type == NONE ? 0 : static_cast<uint8_t>(piece.type | (piece.color == BLACK ? 8 : 0));
+        out[5 + square / 2] |= (square % 2 == 0) ? nibble << 4 : nibble;
+    }
+    uint8_t* files = out + 37;
+    for (PieceColor color : { WHITE, BLACK }) {
+        *files++ = encodeFile(hello.kingCol[color]);
+        *files++ = encodeFile(hello.rookCols[color][LONG_CASTLE]);
+        *files++ = encodeFile(hello.rookCols[color][SHORT_CASTLE]);
+    }
+    out[43] = static_cast<uint8_t>(hello.castling[WHITE][LONG_CASTLE] | hello.castling[WHITE][SHORT_CASTLE] << 1
+                                   | hello.castling[BLACK][LONG_CASTLE] << 2 | hello.castling[BLACK][SHORT_CASTLE] << 3);
+    out[44] = static_cast<uint8_t>(hello.sideToMove);
+}
+
+bool decodeGameHello(const uint8_t* data, int size, GameHello& hello) {
+    if (size != HelloSize || data[0] != HelloVersion || (data[1] & ~FlagBoard) != 0 || !isPlayerColor(data[2])) return false;
+    hello = GameHello();
+    hello.receiverColor = static_cast<PieceColor>(data[2]);
+    if (!(data[1] & FlagBoard)) {
+        hello.spIndex = data[3] << 8 | data[4];
+        return hello.spIndex < Chess960PositionCount;
+    }
+
+    int kings[3] = { 0, 0, 0 };
+    for (int square = 0; square < 64; ++square) {
+        uint8_t nibble = (square % 2 == 0) ? data[5 + square / 2] >> 4 : data[5 + square / 2] & 0xF;
+        int type = nibble & 7;
+        if (nibble == 0) continue;
+        if (type == NONE || type > PAWN) return false;
+        PieceColor color = (nibble & 8) ? BLACK : WHITE;
+        // Пешка на первой или последней горизонтали ходила бы за доску.
+        if (type == PAWN && (squareRow(square) == 0 || squareRow(square) == 7)) return false;
+        if (type == KING) ++kings[color];
+        hello.board[square] = packPiece({ static_cast<PieceType>(type), color });
+    }
+    if (kings[WHITE] != 1 || kings[BLACK] != 1) return false;
+
+    const uint8_t* files = data + 37;
+    for (PieceColor color : { WHITE, BLACK }) {
+        if (!decodeFile(*files++, hello.kingCol[color]) || !decodeFile(*files++, hello.rookCols[color][LONG_CASTLE])
+            || !decodeFile(*files++, hello.rookCols[color][SHORT_CASTLE])) {
+            return false;
+        }
+    }
+    if (data[43] > 0xF || !isPlayerColor(data[44])) return false;
+    hello.castling[WHITE][LONG_CASTLE] = data[43] & 1;
+    hello.castling[WHITE][SHORT_CASTLE] = data[43] & 2;
+    hello.castling[BLACK][LONG_CASTLE] = data[43] & 4;
+    hello.castling[BLACK][SHORT_CASTLE] = data[43] & 8;
+    hello.sideToMove = static_cast<PieceColor>(data[44]);
+    // Право на рокировку — только при короле и ладье на исходных клетках своей горизонтали
+    // (длинная ладья левее короля, короткая — правее), как в Position::setFromFen.
+    for (PieceColor color : { WHITE, BLACK }) {
+        int homeRow = (color == WHITE) ? 7 : 0;
+        int kingCol = hello.kingCol[color];
+        for (int side : { LONG_CASTLE, SHORT_CASTLE }) {
+            if (!hello.castling[color][side]) continue;
+            int rookCol = hello.rookCols[color][side];
+            if (kingCol < 0 || rookCol < 0 || (side == LONG_CASTLE ? rookCol >= kingCol : rookCol <= kingCol)) return false;
+            if (hello.board[makeSquare(homeRow, kingCol)] != packPiece({ KING, color })
+                || hello.board[makeSquare(homeRow, rookCol)] != packPiece({ ROOK, color })) {
+                return false;
+            }
+        }
+    }
+
+    // Король стороны, которая не ходит, под шахом быть не может. Position — на стеке, без выделений.
+    Position position;
+    position.clear();
+    for (int square = 0; square < 64; ++square) {
+        Piece piece = unpackPiece(hello.board[square]);
+        if (piece.type != NONE) position.putPiece(square, piece);
+    }
+    position.setSideToMove(hello.sideToMove);
+    position.updateAttackInfo();
+    return !position.isKingInCheck(oppositeColor(hello.sideToMove));
+}
@@ -0,0 +1,46 @@
+#ifndef GAME_HELLO_H
+#define GAME_HELLO_H
+
+#include "chess_types.h"
+#include "position.h"
+#include <cstdint>
+
+/*
+ * Приветствие сетевой игры: хост сообщает клиенту стартовую позицию и его цвет.
+ * Фиксированные HelloSize байт, числа big-endian:
+ *
+ *   0      версия (HelloVersion)
+ *   1      флаги: бит 0 — передана доска, иначе номер стартовой позиции
+ *   2      цвет получателя (PieceColor)
+ *   3-4    номер стартовой позиции Шарнагля (0xFFFF, если передана доска)
+ *   5-36   доска: по 4 бита на клетку от a8 (старший полубайт — четная клетка),
+ *          тип фигуры | 8 для черных, 0 — пусто
+ *   37-42  исходные вертикали рокировки: король, длинная ладья, короткая ладья —
+ *          белых, затем черных (0xFF — нет)
+ *   43     права на рокировку: биты 0-1 — белые (длинная, короткая), 2-3 — черные
+ *   44     очередь хода (PieceColor)
+ *
+ * Без доски получатель расставляет позицию по номеру сам; поля 5-44 тогда нулевые.
+ * Другую версию получатель отвергает, а не читает наугад.
+ */
+
+const int HelloVersion = 1;
+const int HelloSize = 45;
+
+struct GameHello {
+    PieceColor receiverColor = BLACK;
+    int spIndex = -1;                   // >= 0 — позиция по номеру, остальные поля не используются.
+    PackedPiece board[64] = {};
+    int kingCol[3] = { -1, -1, -1 };    // Индекс — PieceColor.
+    int rookCols[3][2] = { { -1, -1 }, { -1, -1 }, { -1, -1 } }; // [цвет][CastlingSide]
+    bool castling[3][2] = {};
+    PieceColor sideToMove = WHITE;
+};
+
+// Приветствие со стартовой позицией по номеру (spIndex >= 0) или с доской position.
+GameHello makeGameHello(const Position& position, int spIndex, PieceColor receiverColor);
+void encodeGameHello(const GameHello& hello, uint8_t out[HelloSize]);
+// Проверяет версию, размер и значения полей; память не выделяет.
+bool decodeGameHello(const uint8_t* data, int size, GameHello& hello);
+
+#endif // GAME_HELLO_H
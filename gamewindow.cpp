@@ -1,7 +1,12 @@
 #include "gamewindow.h"
 #include "promotiondialog.h"
 #include "networkmanager.h"
+#include "nnue.h"
+#include "tablebase.h"
 
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
 #include <QVBoxLayout>
 #include <QGridLayout>
 #include <QFrame>
@@ -11,6 +16,36 @@
 #include <QPushButton>
 #include <QLineEdit>
 #include <QLabel>
+#include <QStringList>
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <QTextCursor>
+#include <QThread>
+#include <QTimer>
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+namespace {
+
+// Время на позицию и число вариантов при анализе партии.
+const int AnalysisMoveTimeMs = 1000;
+const int AnalysisLines = 3;
+
+// Оценка с точки зрения белых: "+0.35", "+мат в 3" или "+выигрыш по таблицам".
+QString formatScore(int whiteScore)
+{
+    if (isMateScore(whiteScore)) {
+        int plies = MateScore - std::abs(whiteScore);
+        return QString("%1мат в %2").arg(whiteScore > 0 ? "+" : "-").arg((plies + 1) / 2);
+    }
+    if (std::abs(whiteScore) > TbWinScore - MaxPly) {
+        return QString("%1выигрыш по таблицам").arg(whiteScore > 0 ? "+" : "-");
+    }
+    return QString::asprintf("%+.2f", whiteScore / 100.0);
+}
+
+} // namespace
 
 // Конструктор для локальной игры.
 gamewindow::gamewindow(QWidget *parent)
@@ -34,7 +69,7 @@ gamewindow::gamewindow(QWidget *parent)
 }
 
 // Конструктор для сетевой игры.
-gamewindow::gamewindow(NetworkManager *manager, const QString& initialLayout, PieceColor myColor, QWidget *parent)
+gamewindow::gamewindow(NetworkManager *manager, const GameHello& hello, PieceColor myColor, QWidget *parent)
     : QMainWindow(parent), m_logic(new PieceLogic(this)), m_networkManager(manager), m_isNetworkGame(true), m_myColor(myColor)
 {
     m_networkManager->setParent(this);
@@ -48,8 +83,9 @@ gamewindow::gamewindow(NetworkManager *manager, const QString& initialLayout, Pi
     setPalette(pal);
 
     setupUI();
-    // В сетевой игре кнопка "Новая игра" не имеет смысла, скрываем ее.
+    // В сетевой игре кнопки "Новая игра" и "Отменить ход" не имеют смысла, скрываем их.
     findChild<QPushButton*>("newGameButton")->setVisible(false);
+    findChild<QPushButton*>("undoMoveButton")->setVisible(false);
 
     connect(m_logic, &PieceLogic::boardChanged, this, &gamewindow::onBoardChanged);
     connect(m_networkManager, &NetworkManager::moveReceived, this, &gamewindow::onMoveReceived);
@@ -64,7 +100,49 @@ gamewindow::gamewindow(NetworkManager *manager, const QString& initialLayout, Pi
         connect(m_chatInput, &QLineEdit::returnPressed, this, &gamewindow::onSendChatClicked);
     }
 
-    m_logic->setBoardFromLayout(initialLayout);
+    m_logic->setupFromHello(hello);
+    // Кадры, пришедшие вслед за приветствием, разбираются только теперь, когда окно подписано.
+    m_networkManager->resume();
+}
+
+// Конструктор для игры против бота.
+gamewindow::gamewindow(PieceColor botColor, const SearchLimits& botLimits, QWidget *parent)
+    : QMainWindow(parent), m_logic(new PieceLogic(this)), m_networkManager(nullptr), m_isNetworkGame(false),
+      m_myColor(oppositeColor(botColor)), m_botColor(botColor), m_botLimits(botLimits)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowTitle("Chess960 - Игра против бота");
+    setMinimumSize(1280, 720);
+
+    QPalette pal = palette();
+    pal.setColor(QPalette::Window, QColor(45, 45, 45));
+    setAutoFillBackground(true);
+    setPalette(pal);
+
+    setupUI();
+    // Бот ищет на всех ядрах в фоновом потоке; потоки поиска делят одну таблицу перестановок.
+    m_engine = new EngineWorker(this);
+    m_engine->setThreads(QThread::idealThreadCount());
+    connect(m_engine, &EngineWorker::bestMoveFound, this, &gamewindow::onBotMoveFound);
+    connect(m_engine, &EngineWorker::progress, this, &gamewindow::onEngineProgress);
+    connect(m_engine, &EngineWorker::statistics, this, &gamewindow::onEngineStatistics);
+    // Веса NNUE необязательны: без файла рядом с программой бот оценивает позиции классически.
+    QString networkPath = QCoreApplication::applicationDirPath() + "/chess960.nnue";
+    if (!Nnue::isLoaded() && QFile::exists(networkPath)) Nnue::loadNetwork(networkPath.toStdString());
+    // Книга отображается в память через mmap: открытие мгновенное при любом размере.
+    QString bookPath = QCoreApplication::applicationDirPath() + "/chess960.book";
+    if (QFile::exists(bookPath)) m_book.open(bookPath.toStdString());
+    // Таблицы эндшпиля из каталога tablebases рядом с программой (строит chess960-tbgen):
+    // бот играет по ним без ошибок, а партия присуждается, как только позиция попала в таблицы.
+    QString tablebasePath = QCoreApplication::applicationDirPath() + "/tablebases";
+    if (Tablebase::largestTable() == 0 && QDir(tablebasePath).exists()) Tablebase::init(tablebasePath.toStdString());
+    m_logic->setTablebaseAdjudication(Tablebase::largestTable() > 0);
+
+    connect(m_logic, &PieceLogic::boardChanged, this, &gamewindow::onBoardChanged);
+
+    m_logic->setupNewGame();
+    updateBoardUI();
+    startBotSearch();
 }
 
 // Создание и компоновка всех элементов интерфейса.
@@ -80,6 +158,8 @@ void gamewindow::setupUI() {
     QHBoxLayout* buttonsLayout = new QHBoxLayout();
     QPushButton* newGameButton = new QPushButton("Новая игра");
     newGameButton->setObjectName("newGameButton");
+    QPushButton* undoMoveButton = new QPushButton("Отменить ход");
+    undoMoveButton->setObjectName("undoMoveButton");
     QPushButton* backToMenuButton = new QPushButton("В меню");
 
     QString buttonStyle = R"(
@@ -91,12 +171,15 @@ void gamewindow::setupUI() {
         QPushButton:pressed { background-color: #444444; }
     )";
     newGameButton->setStyleSheet(buttonStyle);
+    undoMoveButton->setStyleSheet(buttonStyle);
     backToMenuButton->setStyleSheet(buttonStyle);
 
     connect(newGameButton, &QPushButton::clicked, this, &gamewindow::onNewGameClicked);
+    connect(undoMoveButton, &QPushButton::clicked, this, &gamewindow::onUndoMoveClicked);
     connect(backToMenuButton, &QPushButton::clicked, this, &gamewindow::onBackToMenuClicked);
 
     buttonsLayout->addWidget(newGameButton);
+    buttonsLayout->addWidget(undoMoveButton);
     buttonsLayout->addWidget(backToMenuButton);
     leftPanelLayout->addLayout(buttonsLayout);
     leftPanelLayout->addSpacing(20);
@@ -138,6 +221,16 @@ void gamewindow::setupUI() {
     historyButtonsLayout->addStretch();
 
     leftPanelLayout->addLayout(historyButtonsLayout);
+
+    m_analyseButton = new QPushButton("Анализ партии");
+    m_analyseButton->setStyleSheet(buttonStyle);
+    connect(m_analyseButton, &QPushButton::clicked, this, &gamewindow::onAnalyseGameClicked);
+    leftPanelLayout->addWidget(m_analyseButton);
+
+    m_analysisInfo = new QLabel();
+    m_analysisInfo->setWordWrap(true);
+    m_analysisInfo->setStyleSheet("color: #cccccc; font-family: monospace;");
+    leftPanelLayout->addWidget(m_analysisInfo);
     leftPanelWidget->setLayout(leftPanelLayout);
 
     // ==== ДОСКА ====
@@ -210,6 +303,31 @@ void gamewindow::setupUI() {
 
         rightLayout->addLayout(chatInputLayout);
     } else {
+        if (m_botColor != NO_COLOR) {
+            m_engineInfo = new QLabel();
+            m_engineInfo->setWordWrap(true);
+            m_engineInfo->setMinimumHeight(60);
+            m_engineInfo->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+            m_engineInfo->setStyleSheet("color: #cccccc; font-family: monospace;");
+            rightLayout->addWidget(m_engineInfo);
+
+            // Панель статистики поиска: по кнопке, обновляется по таймеру, пока бот думает.
+            QPushButton* statsButton = new QPushButton("Статистика поиска");
+            statsButton->setCheckable(true);
+            statsButton->setStyleSheet(buttonStyle);
+            connect(statsButton, &QPushButton::toggled, this, &gamewindow::onStatsToggled);
+            rightLayout->addWidget(statsButton);
+
+            m_statsPanel = new QLabel();
+            m_statsPanel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+            m_statsPanel->setStyleSheet("color: #cccccc; font-family: monospace;");
+            m_statsPanel->setVisible(false);
+            rightLayout->addWidget(m_statsPanel);
+
+            m_statsTimer = new QTimer(this);
+            m_statsTimer->setInterval(250);
+            connect(m_statsTimer, &QTimer::timeout, this, &gamewindow::refreshStatsPanel);
+        }
         rightLayout->addStretch(1);
     }
 
@@ -228,6 +346,10 @@ void gamewindow::handleCellClick(int row, int col)
     if (m_isNetworkGame && m_logic->getCurrentTurn() != m_myColor) {
         return;
     }
+    // Пока бот думает над своим ходом, доска не реагирует.
+    if (m_botColor != NO_COLOR && m_logic->getCurrentTurn() == m_botColor && m_logic->getGameStatus() == IN_PROGRESS) {
+        return;
+    }
     // Если игра завершена, клики больше не обрабатываются.
     if (m_logic->getGameStatus() != IN_PROGRESS) {
         m_selectedRow = -1;
@@ -259,14 +381,9 @@ void gamewindow::handleCellClick(int row, int col)
         }
 
         // Пытаемся совершить ход в логике.
-        if (m_logic->tryMove(currentMove)) {
-            // Формируем и добавляем нотацию в историю.
-            QString fromStr = QChar('a' + m_selectedCol) + QString::number(8 - m_selectedRow);
-            QString toStr = QChar('a' + col) + QString::number(8 - row);
-            QMap<PieceType, QString> pieceNames = { {PAWN, "Pawn"}, {KNIGHT, "Knight"}, {BISHOP, "Bishop"}, {ROOK, "Rook"}, {QUEEN, "Queen"}, {KING, "King"} };
-            QString colorStr = (movingPiece.color == WHITE) ? "White" : "Black";
-            QString notation = QString("%1-%2 (%3 %4)").arg(fromStr, toStr, colorStr, pieceNames[movingPiece.type]);
-            m_moveHistory->append(notation);
+        bool moved = m_logic->tryMove(currentMove);
+        if (moved) {
+            appendMoveToHistory(currentMove, movingPiece);
 
             // Если игра сетевая, отправляем ход оппоненту.
             if (m_isNetworkGame) {
@@ -280,6 +397,8 @@ void gamewindow::handleCellClick(int row, int col)
 
         // Проверяем, не закончилась ли игра.
         checkAndDisplayGameEndStatus();
+        // Неудачный клик не должен прерывать обдумывание бота.
+        if (moved) startBotSearch();
     }
 }
 
@@ -289,11 +408,7 @@ void gamewindow::onMoveReceived(const Move& move)
     // Добавляем нотацию полученного хода.
     Piece movingPiece = m_logic->getPieceAt(move.fromRow, move.fromCol);
     if (movingPiece.type != NONE) {
-        QString fromStr = QChar('a' + move.fromCol) + QString::number(8 - move.fromRow);
-        QString toStr = QChar('a' + move.toCol) + QString::number(8 - move.toRow);
-        QMap<PieceType, QString> pieceNames = { {PAWN, "Pawn"}, {KNIGHT, "Knight"}, {BISHOP, "Bishop"}, {ROOK, "Rook"}, {QUEEN, "Queen"}, {KING, "King"} };
-        QString colorStr = (movingPiece.color == WHITE) ? "White" : "Black";
-        m_moveHistory->append(QString("%1-%2 (%3 %4)").arg(fromStr, toStr, colorStr, pieceNames[movingPiece.type]));
+        appendMoveToHistory(move, movingPiece);
     }
 
     // Применяем ход к нашей локальной логике.
@@ -303,6 +418,149 @@ void gamewindow::onMoveReceived(const Move& move)
     checkAndDisplayGameEndStatus();
 }
 
+// Запускает поиск хода бота, если сейчас его очередь. Если бот уже обдумывал
+// именно эту позицию (игрок сделал ожидаемый ход), поиск просто продолжается.
+// Поиск идет в потоке движка: доска и кнопки остаются отзывчивыми.
+void gamewindow::startBotSearch()
+{
+    if (m_botColor == NO_COLOR) return;
+    bool wasPondering = m_botPondering;
+    m_botPondering = false;
+    if (m_logic->getGameStatus() != IN_PROGRESS || m_logic->getCurrentTurn() != m_botColor) {
+        // Отмена хода или новая партия: прежний поиск больше не нужен.
+        m_botSearchId = 0;
+        m_engine->stop();
+        return;
+    }
+
+    const ChessGame& game = m_logic->game();
+    if (wasPondering && m_botSearchId != 0 && game.position().key() == m_ponderKey) {
+        m_engine->ponderHit();
+        return;
+    }
+    // Ход из дебютной книги делается сразу, без поиска.
+    PackedMove bookMove = m_book.isOpen() ? m_book.chooseMove(game.position(), QRandomGenerator::global()->generate()) : NullMove;
+    if (bookMove != NullMove) {
+        m_botSearchId = 0;
+        m_engine->stop();
+        if (m_engineInfo) m_engineInfo->setText("Ход из дебютной книги");
+        playBotMove(bookMove);
+        return;
+    }
+    m_botSearchId = m_engine->start(game.position(), m_botLimits, game.keyHistory());
+}
+
+// Пока игрок думает, бот ищет ответ на ход, которого от него ожидает.
+void gamewindow::startPondering(PackedMove expectedMove)
+{
+    const ChessGame& game = m_logic->game();
+    MoveList legal;
+    generateLegalMoves(game.position(), legal);
+    if (expectedMove == NullMove || std::find(legal.begin(), legal.end(), expectedMove) == legal.end()) return;
+
+    Position position = game.position();
+    UndoInfo undo;
+    position.makeMove(expectedMove, undo);
+    SearchLimits limits = m_botLimits;
+    limits.ponder = true;
+    m_ponderKey = position.key();
+    m_botPondering = true;
+    m_botSearchId = m_engine->start(position, limits, game.keyHistory());
+}
+
+// Ход, найденный движком. Результаты прерванных поисков (номер не совпадает) отбрасываются.
+void gamewindow::onBotMoveFound(int searchId, PackedMove bestMove, PackedMove ponderMove)
+{
+    if (searchId != m_botSearchId || bestMove == NullMove) return;
+    m_botSearchId = 0;
+    if (m_botColor == NO_COLOR || m_logic->getGameStatus() != IN_PROGRESS || m_logic->getCurrentTurn() != m_botColor) return;
+
+    playBotMove(bestMove);
+    if (m_logic->getGameStatus() == IN_PROGRESS) startPondering(ponderMove);
+}
+
+// Делает ход бота на доске и в истории.
+void gamewindow::playBotMove(PackedMove packedMove)
+{
+    Move move = unpackMove(packedMove);
+    Piece movingPiece = m_logic->getPieceAt(move.fromRow, move.fromCol);
+    if (m_logic->tryMove(move)) {
+        appendMoveToHistory(move, movingPiece);
+    }
+    checkAndDisplayGameEndStatus();
+}
+
+// Глубина, оценка (с точки зрения белых), скорость и главный вариант текущего поиска.
+void gamewindow::onEngineProgress(int searchId, int depth, int score, quint64 nodes, quint64 nps, const QString& pv)
+{
+    if (searchId != m_botSearchId || !m_engineInfo) return;
+    QString scoreText = formatScore((m_botColor == WHITE) ? score : -score);
+    m_engineInfo->setText(QString("%1глубина %2  оценка %3\n%4 тыс. узлов  %5 тыс. узлов/с\n%6")
+                              .arg(m_botPondering ? "Обдумывание: " : "")
+                              .arg(depth).arg(scoreText)
+                              .arg(nodes / 1000).arg(nps / 1000).arg(pv));
+}
+
+// Статистика итерации приходит вместе с прогрессом; время итераций берется только из нее.
+void gamewindow::onEngineStatistics(int searchId, const SearchStats& stats)
+{
+    if (searchId != m_botSearchId) return;
+    m_lastStats = stats;
+    refreshStatsPanel();
+}
+
+void gamewindow::onStatsToggled(bool visible)
+{
+    if (!m_statsPanel) return;
+    m_statsPanel->setVisible(visible);
+    if (visible) {
+        m_statsTimer->start();
+        refreshStatsPanel();
+    } else {
+        m_statsTimer->stop();
+    }
+}
+
+// Между итерациями счетчики читаются прямо из потоков поиска (без блокировок).
+void gamewindow::refreshStatsPanel()
+{
+    if (!m_statsPanel || !m_statsPanel->isVisible()) return;
+    SearchStats stats = m_lastStats;
+    if (m_engine && m_engine->isSearching()) {
+        SearchStats live = m_engine->stats();
+        stats.totals = live.totals;
+        stats.threads = live.threads;
+        stats.seconds = live.seconds;
+    }
+
+    // Последние итерации: по ним видно, во сколько раз дороже каждая следующая глубина.
+    QStringList iterations;
+    size_t first = stats.iterationSeconds.size() > 10 ? stats.iterationSeconds.size() - 10 : 0;
+    for (size_t i = first; i < stats.iterationSeconds.size(); ++i) {
+        iterations << QString("%1: %2 мс").arg(i + 1).arg(stats.iterationSeconds[i] * 1000, 0, 'f', 1);
+    }
+    m_statsPanel->setText(QString("Узлы: %1 (потоков %2)\nУзлов/с: %3\nГлубина: %4 / %5\n"
+                                  "Попадания в таблицу: %6%\nОтсечение первым ходом: %7%\n"
+                                  "Форсированные узлы: %8%\nИтерации:\n%9")
+                              .arg(stats.totals.nodes).arg(stats.threads)
+                              .arg(static_cast<quint64>(stats.nps()))
+                              .arg(stats.depth).arg(stats.totals.selDepth)
+                              .arg(stats.ttHitRate() * 100, 0, 'f', 1)
+                              .arg(stats.firstMoveCutoffRate() * 100, 0, 'f', 1)
+                              .arg(stats.qnodeShare() * 100, 0, 'f', 1)
+                              .arg(iterations.join('\n')));
+}
+
+// Добавляет ход в панель истории ("e2-e4 (White Pawn)").
+void gamewindow::appendMoveToHistory(const Move& move, const Piece& movingPiece)
+{
+    QString fromStr = QChar('a' + move.fromCol) + QString::number(8 - move.fromRow);
+    QString toStr = QChar('a' + move.toCol) + QString::number(8 - move.toRow);
+    QMap<PieceType, QString> pieceNames = { {PAWN, "Pawn"}, {KNIGHT, "Knight"}, {BISHOP, "Bishop"}, {ROOK, "Rook"}, {QUEEN, "Queen"}, {KING, "King"} };
+    QString colorStr = (movingPiece.color == WHITE) ? "White" : "Black";
+    m_moveHistory->append(QString("%1-%2 (%3 %4)").arg(fromStr, toStr, colorStr, pieceNames[movingPiece.type]));
+}
+
 // Слот, вызываемый при разрыве соединения.
 void gamewindow::onOpponentDisconnected()
 {
@@ -343,10 +601,21 @@ void gamewindow::checkAndDisplayGameEndStatus()
     if (status != IN_PROGRESS) {
         QString message;
         if (status == CHECKMATE) {
-            QString winner = (m_logic->getCurrentTurn() == WHITE) ? "Черные" : "Белые";
+            QString winner = (m_logic->getWinner() == WHITE) ? "Белые" : "Черные";
             message = "Мат! " + winner + " победили.";
         } else if (status == STALEMATE) {
             message = "Пат! Ничья.";
+        } else if (status == DRAW_REPETITION) {
+            message = "Троекратное повторение позиции. Ничья.";
+        } else if (status == DRAW_FIFTY_MOVES) {
+            message = "50 ходов без взятий и ходов пешкой. Ничья.";
+        } else if (status == DRAW_INSUFFICIENT_MATERIAL) {
+            message = "Недостаточно материала для мата. Ничья.";
+        } else if (status == TABLEBASE_WIN) {
+            QString winner = (m_logic->getWinner() == WHITE) ? "Белые" : "Черные";
+            message = "Позиция выиграна по таблицам эндшпиля. " + winner + " победили.";
+        } else if (status == TABLEBASE_DRAW) {
+            message = "По таблицам эндшпиля позиция ничейная. Ничья.";
         }
         QMessageBox::information(this, "Игра окончена", message);
     }
@@ -359,11 +628,40 @@ void gamewindow::onBoardChanged() {
 
 // Начинает новую партию в локальном режиме.
 void gamewindow::onNewGameClicked() {
+    resetAnalysis();
     m_logic->setupNewGame();
     m_logic->resetHistoryBrowser();
     m_moveHistory->clear();
     m_selectedRow = -1;
     m_selectedCol = -1;
+    startBotSearch();
+}
+
+// Отменяет последний ход в локальной игре (в том числе завершивший партию).
+// Против бота отменяется и его ответ, чтобы снова был ход игрока.
+void gamewindow::onUndoMoveClicked() {
+    if (!undoLastMove()) return;
+    if (m_botColor != NO_COLOR && m_logic->getCurrentTurn() == m_botColor) {
+        undoLastMove();
+    }
+    m_selectedRow = -1;
+    m_selectedCol = -1;
+    startBotSearch();
+}
+
+// Отменяет один полуход и убирает его запись из истории ходов.
+bool gamewindow::undoLastMove() {
+    if (!m_logic->undoMove()) return false;
+    resetAnalysis();
+    if (m_moveHistory->document()->blockCount() <= 1) {
+        m_moveHistory->clear();
+    } else {
+        QTextCursor cursor(m_moveHistory->document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.select(QTextCursor::BlockUnderCursor);
+        cursor.removeSelectedText();
+    }
+    return true;
 }
 
 // Закрывает игровое окно и возвращает в главное меню.
@@ -377,6 +675,7 @@ void gamewindow::onPrevMoveClicked() {
     const Piece* historyBoard = m_logic->browseHistory(-1);
     if (historyBoard) {
         updateBoardUI(historyBoard);
+        showBrowsedAnalysis();
     }
 }
 
@@ -384,7 +683,107 @@ void gamewindow::onNextMoveClicked() {
     const Piece* historyBoard = m_logic->browseHistory(1);
     if (historyBoard) {
         updateBoardUI(historyBoard);
+        showBrowsedAnalysis();
+    }
+}
+
+// Все позиции партии оцениваются параллельно (по позиции на ядро), оценки приходят
+// по мере готовности: ошибки отмечаются в истории ходов, оценка видна при просмотре.
+void gamewindow::onAnalyseGameClicked() {
+    if (!m_analysis) {
+        m_analysis = new AnalysisWorker(this);
+        connect(m_analysis, &AnalysisWorker::positionAnalysed, this, &gamewindow::onPositionAnalysed);
+    }
+    resetAnalysis();
+    std::vector<Position> positions = m_logic->game().historyPositions();
+    m_analysisResults.assign(positions.size(), PositionAnalysis());
+
+    SearchLimits limits;
+    limits.moveTimeMs = AnalysisMoveTimeMs;
+    limits.multiPv = AnalysisLines;
+    m_analysisId = m_analysis->start(positions, m_logic->game().keyHistory(), limits, QThread::idealThreadCount());
+    m_analyseButton->setEnabled(false);
+    m_analysisInfo->setVisible(true);
+    showBrowsedAnalysis();
+}
+
+// Ход ply (из позиции ply в ply + 1) оценивается, как только готовы обе позиции.
+void gamewindow::onPositionAnalysed(int analysisId, const PositionAnalysis& analysis) {
+    if (analysisId != m_analysisId) return;
+    int ply = analysis.ply;
+    m_analysisResults[ply] = analysis;
+    const std::vector<MoveDelta>& moves = m_logic->game().moves();
+    if (ply > 0 && m_analysisResults[ply - 1].ply >= 0) {
+        markMoveQuality(ply - 1, classifyMove(m_analysisResults[ply - 1], analysis, moves[ply - 1].move));
+    }
+    if (ply + 1 < static_cast<int>(m_analysisResults.size()) && m_analysisResults[ply + 1].ply >= 0) {
+        markMoveQuality(ply, classifyMove(analysis, m_analysisResults[ply + 1], moves[ply].move));
+    }
+    if (std::all_of(m_analysisResults.begin(), m_analysisResults.end(),
+                    [](const PositionAnalysis& result) { return result.ply >= 0; })) {
+        m_analyseButton->setEnabled(true);
     }
+    if (ply == m_logic->getCurrentHistoryIndex()) showBrowsedAnalysis();
+}
+
+// Прерывает анализ: партия изменилась, прежние оценки к ней не относятся.
+void gamewindow::resetAnalysis() {
+    if (m_analysis) m_analysis->stop();
+    m_analysisId = 0;
+    m_analysisResults.clear();
+    m_analyseButton->setEnabled(true);
+    m_analysisInfo->clear();
+    // Знаки прежнего анализа снимаются (сама строка хода кончается на ")"),
+    // иначе повторный анализ дописал бы их еще раз.
+    for (QTextBlock block = m_moveHistory->document()->begin(); block.isValid(); block = block.next()) {
+        QString text = block.text();
+        int markLength = text.endsWith(" ??") ? 3 : text.endsWith(" ?") ? 2 : 0;
+        if (markLength == 0) continue;
+        QTextCursor cursor(block);
+        cursor.movePosition(QTextCursor::EndOfBlock);
+        cursor.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor, markLength);
+        cursor.removeSelectedText();
+    }
+}
+
+// "?" — ошибка, "??" — зевок: в конец строки хода в истории.
+void gamewindow::markMoveQuality(int ply, MoveQuality quality) {
+    if (quality == MOVE_GOOD) return;
+    QTextBlock block = m_moveHistory->document()->findBlockByNumber(ply);
+    if (!block.isValid()) return;
+    QTextCursor cursor(block);
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    QTextCharFormat format;
+    format.setForeground(QColor(quality == MOVE_BLUNDER ? "#ff5555" : "#ffaa33"));
+    format.setFontWeight(QFont::Bold);
+    cursor.insertText(quality == MOVE_BLUNDER ? " ??" : " ?", format);
+}
+
+// Оценка и лучшие варианты позиции, открытой в истории.
+void gamewindow::showBrowsedAnalysis() {
+    if (m_analysisId == 0) return;
+    int ply = m_logic->getCurrentHistoryIndex();
+    if (ply < 0 || ply >= static_cast<int>(m_analysisResults.size())) return;
+    const PositionAnalysis& analysis = m_analysisResults[ply];
+    if (analysis.ply < 0) {
+        m_analysisInfo->setText(QString("Позиция %1: анализ...").arg(ply));
+        return;
+    }
+    if (analysis.depth == 0) {
+        QString result = isMateScore(analysis.score) ? "мат" : "ничья";
+        m_analysisInfo->setText(QString("Позиция %1: %2").arg(ply).arg(result));
+        return;
+    }
+    int sign = analysis.sideToMove == WHITE ? 1 : -1;
+    QStringList lines;
+    for (const SearchLine& line : analysis.lines) {
+        QStringList pv;
+        for (size_t i = 0; i < line.pv.size() && i < 6; ++i) pv << QString::fromStdString(moveToString(line.pv[i]));
+        lines << QString("%1  %2").arg(formatScore(sign * line.score), pv.join(' '));
+    }
+    m_analysisInfo->setText(QString("Позиция %1: оценка %2 (глубина %3)\n%4")
+                                .arg(ply).arg(formatScore(analysis.score)).arg(analysis.depth)
+                                .arg(lines.join('\n')));
 }
 
 // Полностью перерисовывает доску и элементы интерфейса.
@@ -420,13 +819,10 @@ void gamewindow::updateBoardUI(const Piece* boardState) {
         }
         // Подсвечиваем короля под шахом
         if (m_logic->isKingInCheck(m_logic->getCurrentTurn())) {
-            for (int r = 0; r < 8; ++r) for (int c = 0; c < 8; ++c) {
-                    Piece p = m_logic->getPieceAt(r, c);
-                    if (p.type == KING && p.color == m_logic->getCurrentTurn()) {
-                        m_boardCells[r][c]->setStyleSheet("background-color: #ff6666;");
-                        break;
-                    }
-                }
+            std::pair<int, int> king = m_logic->getKingPosition(m_logic->getCurrentTurn());
+            if (king.first != -1) {
+                m_boardCells[king.first][king.second]->setStyleSheet("background-color: #ff6666;");
+            }
         }
     }
 
@@ -434,6 +830,8 @@ void gamewindow::updateBoardUI(const Piece* boardState) {
     bool isGameOver = m_logic->getGameStatus() != IN_PROGRESS;
     m_prevMoveButton->setVisible(isGameOver);
     m_nextMoveButton->setVisible(isGameOver);
+    m_analyseButton->setVisible(isGameOver);
+    m_analysisInfo->setVisible(isGameOver && m_analysisId != 0);
 
     if (isGameOver) {
         m_prevMoveButton->setEnabled(m_logic->getCurrentHistoryIndex() > 0);
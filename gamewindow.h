@@ -3,6 +3,9 @@
 
 #include "clickablelabel.h"
 #include "piece_logic.h"
+#include "engineworker.h"
+#include "analysisworker.h"
+#include "opening_book.h"
 #include <QMainWindow>
 #include <QTextEdit>
 #include <QGridLayout>
@@ -10,6 +13,8 @@
 // Предварительные объявления для уменьшения зависимостей в заголовках.
 class QPushButton;
 class QLineEdit;
+class QLabel;
+class QTimer;
 class NetworkManager;
 
 /**
@@ -28,7 +33,10 @@ public:
     explicit gamewindow(QWidget *parent = nullptr);
 
     // Конструктор для сетевой игры.
-    explicit gamewindow(NetworkManager *manager, const QString& initialLayout, PieceColor myColor, QWidget *parent = nullptr);
+    explicit gamewindow(NetworkManager *manager, const GameHello& hello, PieceColor myColor, QWidget *parent = nullptr);
+
+    // Конструктор для игры против бота: botColor — цвет бота, limits — его сила.
+    explicit gamewindow(PieceColor botColor, const SearchLimits& botLimits, QWidget *parent = nullptr);
 
 signals:
     // Сигнал для возврата в главное меню.
@@ -38,10 +46,22 @@ private slots:
     // Обработка действий пользователя
     void handleCellClick(int row, int col);
     void onNewGameClicked();
+    void onUndoMoveClicked();
     void onBackToMenuClicked();
     void onPrevMoveClicked();
     void onNextMoveClicked();
 
+    // Движок бота: ход найден / очередная итерация поиска
+    void onBotMoveFound(int searchId, PackedMove move, PackedMove ponderMove);
+    void onEngineProgress(int searchId, int depth, int score, quint64 nodes, quint64 nps, const QString& pv);
+    void onEngineStatistics(int searchId, const SearchStats& stats);
+    void onStatsToggled(bool visible);
+    void refreshStatsPanel();
+
+    // Анализ законченной партии: запуск и очередная оцененная позиция
+    void onAnalyseGameClicked();
+    void onPositionAnalysed(int analysisId, const PositionAnalysis& analysis);
+
     // Реакция на изменения в логике
     void onBoardChanged();
 
@@ -61,6 +81,8 @@ private:
     QGridLayout* m_blackCapturedLayout;       // Layout для съеденных черных фигур.
     QPushButton* m_prevMoveButton;            // Кнопка "<" для истории.
     QPushButton* m_nextMoveButton;            // Кнопка ">" для истории.
+    QPushButton* m_analyseButton;             // "Анализ партии" (после окончания игры).
+    QLabel* m_analysisInfo;                   // Оценка просматриваемой позиции по анализу.
 
     // Элементы чата (ТОЛЬКО для сетевой игры; в локальном режиме не используются/скрыты)
     QTextEdit* m_chatHistory = nullptr;       // История переписки (read-only).
@@ -76,6 +98,20 @@ private:
     int m_selectedCol = -1;
     bool m_isNetworkGame = false;             // Флаг, определяющий режим игры.
     PieceColor m_myColor;                     // Цвет фигур этого игрока в сетевой игре.
+    PieceColor m_botColor = NO_COLOR;         // Цвет бота; NO_COLOR — игра без бота.
+    SearchLimits m_botLimits;                 // Сила бота: глубина, узлы или время на ход.
+    EngineWorker* m_engine = nullptr;         // Движок бота (ищет в своем потоке).
+    int m_botSearchId = 0;                    // Номер поиска, результат которого ждем; 0 — не ждем.
+    bool m_botPondering = false;              // Бот обдумывает ожидаемый ход игрока.
+    uint64_t m_ponderKey = 0;                 // Хеш позиции после ожидаемого хода игрока.
+    OpeningBook m_book;                       // Дебютная книга бота (если файл есть рядом с программой).
+    QLabel* m_engineInfo = nullptr;           // Глубина, оценка и вариант бота (только игра с ботом).
+    QLabel* m_statsPanel = nullptr;           // Счетчики поиска бота (скрыта, пока не включена кнопкой).
+    QTimer* m_statsTimer = nullptr;           // Опрос счетчиков во время поиска.
+    SearchStats m_lastStats;                  // Статистика последней итерации (с временем итераций).
+    AnalysisWorker* m_analysis = nullptr;     // Анализ партии (создается по кнопке).
+    int m_analysisId = 0;                     // Номер текущего анализа; 0 — анализа нет.
+    std::vector<PositionAnalysis> m_analysisResults; // По позициям партии; ply == -1 — еще не готова.
 
     // Приватные методы для настройки и обновления UI
     void setupUI();
@@ -85,6 +121,14 @@ private:
     void clearLayout(QLayout* layout);
     QString getPieceImagePath(const Piece& piece);
     void checkAndDisplayGameEndStatus();
+    void appendMoveToHistory(const Move& move, const Piece& movingPiece);
+    bool undoLastMove();
+    void startBotSearch();
+    void startPondering(PackedMove expectedMove);
+    void playBotMove(PackedMove move);
+    void resetAnalysis();
+    void markMoveQuality(int ply, MoveQuality quality);
+    void showBrowsedAnalysis();
 };
 
 #endif // GAMEWINDOW_H
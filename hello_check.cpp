@@ -0,0 +1,66 @@
+#include "chess_game.h"
+#include "game_hello.h"
+#include "startpos.h"
+
+#include <cstdint>
+#include <cstdio>
+
+/*
+ * chess960-hello-check — проверка приветствия сетевой игры (game_hello.h):
+ * кодирование и разбор всех стартовых позиций и отказ на недопустимых.
+ * Код возврата 1, если хоть одна проверка не прошла.
+ */
+
+namespace {
+
+// Приветствие с доской: все 960 позиций разбираются обратно в ту же позицию,
+// а недопустимые доски и права на рокировку отвергаются. Возвращает число ошибок.
+int checkHello() {
+    int failures = 0;
+    uint8_t data[HelloSize];
+    GameHello decoded;
+    for (int sp = 0; sp < Chess960PositionCount; ++sp) {
+        Position position;
+        setupStartPosition(position, sp);
+        encodeGameHello(makeGameHello(position, -1, BLACK), data);
+        ChessGame game;
+        bool valid = decodeGameHello(data, HelloSize, decoded);
+        if (valid) game.setupFromHello(decoded);
+        if (!valid || game.position().fen() != position.fen() || game.getStartPositionIndex() != sp) {
+            std::printf("SP %d: round trip failed\n", sp);
+            ++failures;
+        }
+    }
+
+    Position classical;
+    setupStartPosition(classical, ClassicalStartPosition);
+    const GameHello base = makeGameHello(classical, -1, BLACK);
+    struct Case { const char* name; GameHello hello; int version; };
+    Case cases[] = { { "white pawn on b8", base, HelloVersion }, { "black pawn on h1", base, HelloVersion },
+                     { "no rook on h1", base, HelloVersion }, { "king off its file", base, HelloVersion },
+                     { "side not to move in check", base, HelloVersion }, { "wrong version", base, HelloVersion + 1 } };
+    cases[0].hello.board[makeSquare(0, 1)] = packPiece({ PAWN, WHITE });
+    cases[1].hello.board[makeSquare(7, 7)] = packPiece({ PAWN, BLACK });
+    cases[1].hello.castling[WHITE][SHORT_CASTLE] = false;
+    cases[2].hello.board[makeSquare(7, 7)] = 0;
+    cases[3].hello.kingCol[WHITE] = 3;
+    cases[4].hello.board[makeSquare(1, 4)] = 0;
+    cases[4].hello.board[makeSquare(4, 4)] = packPiece({ QUEEN, WHITE });
+    for (const Case& invalid : cases) {
+        encodeGameHello(invalid.hello, data);
+        data[0] = static_cast<uint8_t>(invalid.version);
+        if (decodeGameHello(data, HelloSize, decoded)) {
+            std::printf("%s: accepted\n", invalid.name);
+            ++failures;
+        }
+    }
+    std::printf("Hello: %d positions round-tripped, %d invalid cases checked, %d failures\n",
+                Chess960PositionCount, static_cast<int>(sizeof(cases) / sizeof(cases[0])), failures);
+    return failures;
+}
+
+} // namespace
+
+int main() {
+    return checkHello() == 0 ? 0 : 1;
+}
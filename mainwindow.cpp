@@ -4,8 +4,27 @@
 #include "gamewindow.h"
 #include "networksetupdialog.h"
 #include <QMessageBox>
+#include <QInputDialog>
 #include <QTcpSocket>
 
+namespace {
+
+// Уровни силы бота: ограничение поиска по глубине или по времени на ход.
+struct BotLevel {
+    const char* name;
+    int depth;
+    int moveTimeMs;
+};
+
+const BotLevel BotLevels[] = {
+    { "Новичок (глубина 1)",       1, 0 },
+    { "Любитель (глубина 3)",      3, 0 },
+    { "Сильный (1 секунда на ход)", 0, 1000 },
+    { "Максимальный (3 секунды на ход)", 0, 3000 },
+};
+
+} // namespace
+
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow), game_w(nullptr)
 {
@@ -41,8 +60,27 @@ void MainWindow::handleReturnToMenu()
     this->show();
 }
 
-// Заглушка для игры с ботом.
-void MainWindow::on_pushButton_play2_clicked() { QMessageBox::about(this, "ИГРА ПРОТИВ БОТА", "Игра против бота находится в разработке"); }
+// Запускает игру против бота: игрок выбирает силу бота и играет белыми.
+void MainWindow::on_pushButton_play2_clicked()
+{
+    if (game_w) return;
+
+    QStringList levelNames;
+    for (const BotLevel& level : BotLevels) levelNames << QString::fromUtf8(level.name);
+    bool ok = false;
+    QString choice = QInputDialog::getItem(this, "Игра против бота", "Сила бота:", levelNames, 1, false, &ok);
+    if (!ok) return;
+
+    SearchLimits limits;
+    const BotLevel& level = BotLevels[levelNames.indexOf(choice)];
+    limits.depth = level.depth;
+    limits.moveTimeMs = level.moveTimeMs;
+
+    hide();
+    game_w = new gamewindow(BLACK, limits);
+    connect(game_w, &gamewindow::menuRequested, this, &MainWindow::handleReturnToMenu);
+    game_w->showMaximized();
+}
 
 // Запускает процесс настройки и старта сетевой игры.
 void MainWindow::on_pushButton_play3_clicked()
@@ -51,18 +89,16 @@ void MainWindow::on_pushButton_play3_clicked()
     // Показываем диалог настройки и ждем, пока пользователь его не закроет.
     if (dialog.exec() == QDialog::Accepted) {
         // Если настройка прошла успешно, получаем данные из диалога.
-        QTcpSocket* socket = dialog.getSocket();
-        QString initialLayout = dialog.getInitialBoardLayout();
+        // NetworkManager создан диалогом на уже установленном сокете.
+        NetworkManager *netManager = dialog.takeNetworkManager();
+        GameHello hello = dialog.getHello();
         PieceColor playerColor = dialog.getPlayerColor();
 
-        if (!socket) return;
-
-        // Создаем NetworkManager с уже установленным сокетом.
-        NetworkManager *netManager = new NetworkManager(socket);
+        if (!netManager) return;
 
         // Создаем игровое окно в сетевом режиме.
         hide();
-        game_w = new gamewindow(netManager, initialLayout, playerColor);
+        game_w = new gamewindow(netManager, hello, playerColor);
 
         connect(game_w, &gamewindow::menuRequested, this, &MainWindow::handleReturnToMenu);
         game_w->showMaximized();
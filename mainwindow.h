@@ -28,7 +28,7 @@ public:
 
 private slots:
     // Слоты для кнопок главного меню.
-    void on_pushButton_play2_clicked(); // Игра с ботом (заглушка)
+    void on_pushButton_play2_clicked(); // Игра с ботом
     void on_pushButton_play3_clicked(); // Сетевая игра
     void on_pushButton_play1_clicked(); // Локальная игра
     void on_pushButton_guide_clicked();
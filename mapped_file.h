@@ -0,0 +1,51 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Файл, отображенный в память только для чтения (mmap / MapViewOfFile).
+ *
+ * Страницы подгружаются системой при первом обращении, поэтому открытие не зависит
+ * от размера файла, а несколько процессов делят одну копию в кеше страниц.
+ * Используется дебютной книгой и таблицами эндшпиля.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // randomAccess — обращения вразброс (двоичный поиск): упреждающее чтение отключается.
+    bool open(const std::string& path, bool randomAccess, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
+
+// Целые little-endian в файлах книги и таблиц: формат не зависит от процессора.
+inline unsigned long long readLittleEndian(const unsigned char* bytes, int size) {
+    unsigned long long value = 0;
+    for (int i = size - 1; i >= 0; --i) value = (value << 8) | bytes[i];
+    return value;
+}
+
+inline void writeLittleEndian(unsigned char* bytes, unsigned long long value, int size) {
+    for (int i = 0; i < size; ++i, value >>= 8) bytes[i] = static_cast<unsigned char>(value & 0xFF);
+}
+
+#endif // MAPPED_FILE_H
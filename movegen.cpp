@@ -0,0 +1,283 @@
+#include "movegen.h"
+#include <algorithm>
+
+namespace {
+
+void addMoves(MoveList& moves, int from, Bitboard targets) {
+    while (targets) {
+        int to = popLsb(targets);
+        moves.push_back(packMove(from, to));
+    }
+}
+
+void addPawnMove(MoveList& moves, int from, int to) {
+    int toRow = squareRow(to);
+    if (toRow == 0 || toRow == 7) {
+        for (PieceType promotion : {QUEEN, ROOK, BISHOP, KNIGHT}) moves.push_back(packMove(from, to, promotion));
+    } else {
+        moves.push_back(packMove(from, to));
+    }
+}
+
+// capturesOnly: только взятия (в том числе на проходе) и превращения — для форсированного поиска.
+void generatePawnMoves(const Position& position, MoveList& moves, Bitboard fromMask, bool capturesOnly) {
+    PieceColor us = position.sideToMove();
+    Bitboard occupied = position.occupied();
+    Bitboard enemies = position.pieces(oppositeColor(us));
+    if (position.enPassantSquare() != -1) enemies |= squareBB(position.enPassantSquare());
+
+    int direction = (us == WHITE) ? -8 : 8;
+    int startRow = (us == WHITE) ? 6 : 1;
+    Bitboard pawns = position.pieces(us, PAWN) & fromMask;
+    while (pawns) {
+        int from = popLsb(pawns);
+        Bitboard captures = pawnAttacks(us, from) & enemies;
+        while (captures) addPawnMove(moves, from, popLsb(captures));
+
+        int oneStep = from + direction;
+        if (occupied & squareBB(oneStep)) continue;
+        if (capturesOnly && squareRow(oneStep) != 0 && squareRow(oneStep) != 7) continue;
+        addPawnMove(moves, from, oneStep);
+        int twoSteps = oneStep + direction;
+        if (squareRow(from) == startRow && !(occupied & squareBB(twoSteps))) addPawnMove(moves, from, twoSteps);
+    }
+}
+
+// Рокировка Chess960: все клетки между начальными и конечными полями короля и ладьи
+// должны быть пусты, король не под шахом и не проходит через битые поля.
+// Шах и путь короля берутся из карт атак; конечная клетка проверяется
+// с занятостью после рокировки, так что ход выпускается полностью легальным.
+void generateCastlingMoves(const Position& position, MoveList& moves, Bitboard fromMask) {
+    PieceColor us = position.sideToMove();
+    int homeRow = (us == WHITE) ? 7 : 0;
+    int kingCol = position.kingInitialCol(us);
+    if (kingCol < 0) return;
+    int kingFrom = makeSquare(homeRow, kingCol);
+    if (!(position.pieces(us, KING) & fromMask & squareBB(kingFrom))) return;
+
+    if (position.checkers()) return;
+    PieceColor them = oppositeColor(us);
+    Bitboard enemies = position.pieces(them);
+
+    for (int side : {LONG_CASTLE, SHORT_CASTLE}) {
+        if (!position.canCastle(us, side)) continue;
+        int rookCol = position.rookInitialCol(us, side);
+        int rookFrom = makeSquare(homeRow, rookCol);
+        if (!(position.pieces(us, ROOK) & squareBB(rookFrom))) continue;
+
+        int kingDestCol = (side == SHORT_CASTLE) ? 6 : 2;
+        int rookDestCol = (side == SHORT_CASTLE) ? 5 : 3;
+        Bitboard occupied = position.occupied() ^ squareBB(kingFrom) ^ squareBB(rookFrom);
+        int pathStart = std::min({kingCol, rookCol, kingDestCol, rookDestCol});
+        int pathEnd = std::max({kingCol, rookCol, kingDestCol, rookDestCol});
+        Bitboard path = 0;
+        for (int c = pathStart; c <= pathEnd; ++c) path |= squareBB(makeSquare(homeRow, c));
+        if (path & occupied) continue;
+
+        int kingTo = makeSquare(homeRow, kingDestCol);
+        if (position.attackedBy(them) & betweenBB(kingFrom, kingTo)) continue;
+        Bitboard occupiedAfter = occupied | squareBB(kingTo) | squareBB(makeSquare(homeRow, rookDestCol));
+        if (position.attackersTo(kingTo, occupiedAfter) & enemies) continue;
+
+        moves.push_back(packMove(kingFrom, rookFrom));
+    }
+}
+
+void generatePieceMoves(const Position& position, MoveList& moves, Bitboard fromMask, bool capturesOnly) {
+    PieceColor us = position.sideToMove();
+    Bitboard occupied = position.occupied();
+    Bitboard targets = capturesOnly ? position.pieces(oppositeColor(us)) : ~position.pieces(us);
+
+    generatePawnMoves(position, moves, fromMask, capturesOnly);
+
+    Bitboard knights = position.pieces(us, KNIGHT) & fromMask;
+    while (knights) {
+        int from = popLsb(knights);
+        addMoves(moves, from, knightAttacks(from) & targets);
+    }
+    Bitboard bishops = position.pieces(us, BISHOP) & fromMask;
+    while (bishops) {
+        int from = popLsb(bishops);
+        addMoves(moves, from, bishopAttacks(from, occupied) & targets);
+    }
+    Bitboard rooks = position.pieces(us, ROOK) & fromMask;
+    while (rooks) {
+        int from = popLsb(rooks);
+        addMoves(moves, from, rookAttacks(from, occupied) & targets);
+    }
+    Bitboard queens = position.pieces(us, QUEEN) & fromMask;
+    while (queens) {
+        int from = popLsb(queens);
+        addMoves(moves, from, queenAttacks(from, occupied) & targets);
+    }
+    Bitboard kings = position.pieces(us, KING) & fromMask;
+    while (kings) {
+        int from = popLsb(kings);
+        addMoves(moves, from, kingAttacks(from) & targets);
+    }
+}
+
+} // namespace
+
+void generatePseudoLegalMoves(const Position& position, MoveList& moves, Bitboard fromMask) {
+    generatePieceMoves(position, moves, fromMask, false);
+    generateCastlingMoves(position, moves, fromMask);
+}
+
+void generatePseudoLegalCaptures(const Position& position, MoveList& moves) {
+    generatePieceMoves(position, moves, ~Bitboard(0), true);
+}
+
+void generateLegalMoves(const Position& position, MoveList& moves, Bitboard fromMask) {
+    MoveList pseudoLegal;
+    generatePseudoLegalMoves(position, pseudoLegal, fromMask);
+    for (PackedMove move : pseudoLegal) {
+        if (position.isLegal(move)) moves.push_back(move);
+    }
+}
+
+bool hasAnyLegalMove(const Position& position) {
+    MoveList pseudoLegal;
+    generatePseudoLegalMoves(position, pseudoLegal);
+    for (PackedMove move : pseudoLegal) {
+        if (position.isLegal(move)) return true;
+    }
+    return false;
+}
+
+std::string moveToString(PackedMove move) {
+    int from = moveFrom(move), to = moveTo(move);
+    std::string result;
+    result += static_cast<char>('a' + squareCol(from));
+    result += static_cast<char>('8' - squareRow(from));
+    result += static_cast<char>('a' + squareCol(to));
+    result += static_cast<char>('8' - squareRow(to));
+    switch (movePromotion(move)) {
+    case QUEEN:  result += 'q'; break;
+    case ROOK:   result += 'r'; break;
+    case BISHOP: result += 'b'; break;
+    case KNIGHT: result += 'n'; break;
+    default: break;
+    }
+    return result;
+}
+
+namespace {
+
+PieceType promotionFromChar(char letter) {
+    switch (letter) {
+    case 'q': case 'Q': return QUEEN;
+    case 'r': case 'R': return ROOK;
+    case 'b': case 'B': return BISHOP;
+    case 'n': case 'N': return KNIGHT;
+    default: return NONE;
+    }
+}
+
+bool isFileChar(char c) { return c >= 'a' && c <= 'h'; }
+bool isRankChar(char c) { return c >= '1' && c <= '8'; }
+int squareFromChars(char file, char rank) { return makeSquare('8' - rank, file - 'a'); }
+
+// "e2e4", "e2-e4", "e2xd3", "e7e8q", "e7-e8=Q", "e7-e8".
+PackedMove parseCoordinateMove(const Position& position, const MoveList& legal, const std::string& text) {
+    size_t index = 0;
+    if (text.size() < 4 || !isFileChar(text[0]) || !isRankChar(text[1])) return NullMove;
+    int from = squareFromChars(text[0], text[1]);
+    index = 2;
+    if (text[index] == '-' || text[index] == 'x' || text[index] == ':') ++index;
+    if (index + 2 > text.size() || !isFileChar(text[index]) || !isRankChar(text[index + 1])) return NullMove;
+    int to = squareFromChars(text[index], text[index + 1]);
+    index += 2;
+    if (index < text.size() && text[index] == '=') ++index;
+    PieceType promotion = NONE;
+    if (index < text.size()) {
+        promotion = promotionFromChar(text[index++]);
+        if (promotion == NONE) return NullMove;
+    }
+    if (index != text.size()) return NullMove;
+
+    // Превращение без указания фигуры — в ферзя, как в ChessGame::findLegalMove.
+    PackedMove exact = packMove(from, to, promotion);
+    PackedMove queening = packMove(from, to, QUEEN);
+    for (PackedMove move : legal) {
+        if (move == exact || (promotion == NONE && move == queening)) return move;
+    }
+    // Рокировка записана ходом короля на g/c (классическая запись).
+    for (PackedMove move : legal) {
+        if (moveFrom(move) != from || !position.isCastlingMove(move)) continue;
+        int kingTargetCol = (squareCol(moveTo(move)) > squareCol(from)) ? 6 : 2;
+        if (to == makeSquare(squareRow(from), kingTargetCol)) return move;
+    }
+    return NullMove;
+}
+
+PackedMove parseSanMove(const Position& position, const MoveList& legal, std::string text) {
+    if (text == "O-O" || text == "0-0" || text == "O-O-O" || text == "0-0-0") {
+        bool isShort = text.size() == 3;
+        int kingSquare = position.kingSquare(position.sideToMove());
+        for (PackedMove move : legal) {
+            if (!position.isCastlingMove(move)) continue;
+            if ((squareCol(moveTo(move)) > squareCol(kingSquare)) == isShort) return move;
+        }
+        return NullMove;
+    }
+
+    PieceType type = PAWN;
+    switch (text.empty() ? ' ' : text[0]) {
+    case 'K': type = KING; break;
+    case 'Q': type = QUEEN; break;
+    case 'R': type = ROOK; break;
+    case 'B': type = BISHOP; break;
+    case 'N': type = KNIGHT; break;
+    default: break;
+    }
+    if (type != PAWN) text.erase(0, 1);
+
+    PieceType promotion = NONE;
+    size_t equals = text.find('=');
+    if (equals != std::string::npos) {
+        if (equals + 2 != text.size()) return NullMove;
+        promotion = promotionFromChar(text[equals + 1]);
+        text.erase(equals);
+    } else if (type == PAWN && text.size() >= 3 && promotionFromChar(text.back()) != NONE && isRankChar(text[text.size() - 2])) {
+        promotion = promotionFromChar(text.back());
+        text.pop_back();
+    }
+    if (text.size() < 2 || !isFileChar(text[text.size() - 2]) || !isRankChar(text.back())) return NullMove;
+    int to = squareFromChars(text[text.size() - 2], text.back());
+    text.resize(text.size() - 2);
+    if (!text.empty() && (text.back() == 'x' || text.back() == ':')) text.pop_back();
+
+    // Оставшееся — уточнение исходной клетки: вертикаль, горизонталь или обе.
+    int fromCol = -1, fromRow = -1;
+    for (char c : text) {
+        if (isFileChar(c)) fromCol = c - 'a';
+        else if (isRankChar(c)) fromRow = '8' - c;
+        else return NullMove;
+    }
+
+    PackedMove found = NullMove;
+    for (PackedMove move : legal) {
+        int from = moveFrom(move);
+        if (moveTo(move) != to || movePromotion(move) != promotion || position.isCastlingMove(move)) continue;
+        if (position.pieceAt(from).type != type) continue;
+        if ((fromCol != -1 && squareCol(from) != fromCol) || (fromRow != -1 && squareRow(from) != fromRow)) continue;
+        if (found != NullMove) return NullMove;  // Неоднозначная запись.
+        found = move;
+    }
+    return found;
+}
+
+} // namespace
+
+PackedMove parseMove(const Position& position, const std::string& text) {
+    // Оценки и шах/мат в конце записи ("Nf3+", "e4!?") на ход не влияют.
+    std::string move = text;
+    while (!move.empty() && (move.back() == '+' || move.back() == '#' || move.back() == '!' || move.back() == '?')) move.pop_back();
+    if (move.empty()) return NullMove;
+
+    MoveList legal;
+    generateLegalMoves(position, legal);
+    PackedMove coordinate = parseCoordinateMove(position, legal, move);
+    return (coordinate != NullMove) ? coordinate : parseSanMove(position, legal, move);
+}
@@ -0,0 +1,41 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "position.h"
+#include <string>
+
+// Список упакованных ходов фиксированного размера на стеке (в любой позиции меньше 256 ходов).
+struct MoveList {
+    PackedMove moves[256];
+    int size = 0;
+
+    void push_back(PackedMove move) { moves[size++] = move; }
+    bool empty() const { return size == 0; }
+    const PackedMove* begin() const { return moves; }
+    const PackedMove* end() const { return moves + size; }
+    PackedMove operator[](int index) const { return moves[index]; }
+};
+
+// Псевдолегальные ходы стороны, которой ходить: по правилам движения фигур,
+// без проверки шаха своему королю. Рокировка генерируется сразу легальной.
+// fromMask ограничивает генерацию фигурами на указанных клетках.
+void generatePseudoLegalMoves(const Position& position, MoveList& moves, Bitboard fromMask = ~Bitboard(0));
+
+// Псевдолегальные взятия (включая взятие на проходе) и превращения — для форсированного поиска.
+void generatePseudoLegalCaptures(const Position& position, MoveList& moves);
+
+// Только легальные ходы (псевдолегальные, отфильтрованные Position::isLegal).
+void generateLegalMoves(const Position& position, MoveList& moves, Bitboard fromMask = ~Bitboard(0));
+
+// Есть ли у стороны, которой ходить, хотя бы один легальный ход.
+bool hasAnyLegalMove(const Position& position);
+
+// Координатная запись хода: "e2e4", "e7e8q"; рокировка — "король берет ладью" ("e1h1").
+std::string moveToString(PackedMove move);
+
+// Легальный ход позиции по записи или NullMove, если такого хода нет (или запись неоднозначна).
+// Принимаются координатная запись ("e2e4", "e2-e4", "e7e8q", "e7-e8=Q"; без фигуры — ферзь; рокировка —
+// "король берет ладью" или ход короля на g/c) и алгебраическая (SAN: "Nf3", "exd5", "O-O").
+PackedMove parseMove(const Position& position, const std::string& text);
+
+#endif // MOVEGEN_H
@@ -1,81 +1,134 @@
 #include "networkmanager.h"
 #include <QTcpSocket>
-#include <QDataStream>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
 
 NetworkManager::NetworkManager(QTcpSocket *socket, QObject *parent)
     : QObject(parent), m_socket(socket)
 {
     // NetworkManager теперь управляет временем жизни сокета.
     m_socket->setParent(this);
+    m_receiveBuffer.resize(HeaderSize + MaxPayloadSize);
 
     // Подключаем сигналы сокета к нашим обработчикам.
     connect(m_socket, &QTcpSocket::readyRead, this, &NetworkManager::onReadyRead);
     connect(m_socket, &QTcpSocket::disconnected, this, &NetworkManager::onSocketStateChanged);
 }
 
-// Сериализует и отправляет ход в бинарном виде.
-void NetworkManager::sendMove(const Move& move)
+// Заголовок собирается на стеке, данные пишутся как есть: сокет копирует их
+// в свой буфер отправки, так что на сообщение не создается ни QByteArray, ни QDataStream.
+void NetworkManager::writeFrame(MessageType type, const char* payload, int size)
 {
     if (!m_socket || m_socket->state() != QAbstractSocket::ConnectedState) return;
 
-    QByteArray block;
-    QDataStream out(&block, QIODevice::WriteOnly);
-    out.setVersion(QDataStream::Qt_5_15); // Для совместимости.
-
-    // Записываем тип сообщения и все поля структуры Move.
-    out << static_cast<quint8>(MsgMove)
-        << static_cast<quint8>(move.fromRow) << static_cast<quint8>(move.fromCol)
-        << static_cast<quint8>(move.toRow)   << static_cast<quint8>(move.toCol)
-        << static_cast<quint8>(move.promotion);
+    char header[HeaderSize];
+    qToBigEndian<quint16>(static_cast<quint16>(size), header);
+    header[2] = static_cast<char>(type);
+    m_socket->write(header, HeaderSize);
+    if (size > 0) m_socket->write(payload, size);
+}
 
-    m_socket->write(block);
+// Отправляет ход в упакованном виде (16 бит).
+void NetworkManager::sendMove(const Move& move)
+{
+    char payload[2];
+    qToBigEndian<quint16>(static_cast<quint16>(packMove(move)), payload);
+    writeFrame(MsgMove, payload, sizeof(payload));
 }
 
 // Отправляет текстовое сообщение чата.
 void NetworkManager::sendChatMessage(const QString &message)
 {
-    if (!m_socket || m_socket->state() != QAbstractSocket::ConnectedState) return;
-
-    QByteArray block;
-    QDataStream out(&block, QIODevice::WriteOnly);
-    out.setVersion(QDataStream::Qt_5_15);
+    int length = std::min(static_cast<int>(message.size()), MaxChatLength);
+    // Буфер только растет: после первых сообщений новых выделений памяти нет.
+    if (m_sendBuffer.size() < length * 2) m_sendBuffer.resize(length * 2);
+    qToBigEndian<quint16>(message.utf16(), length, m_sendBuffer.data());
+    writeFrame(MsgChat, m_sendBuffer.constData(), length * 2);
+}
 
-    out << static_cast<quint8>(MsgChat) << message;
+void NetworkManager::sendHello(const GameHello& hello)
+{
+    uint8_t payload[HelloSize];
+    encodeGameHello(hello, payload);
+    writeFrame(MsgHello, reinterpret_cast<const char*>(payload), HelloSize);
+}
 
-    m_socket->write(block);
+void NetworkManager::resume()
+{
+    m_paused = false;
+    if (!processFrames()) return;
+    if (m_socket->bytesAvailable() > 0) onReadyRead();
 }
 
-// Вызывается, когда в сокет приходят данные.
+// Вызывается, когда в сокет приходят данные: дописывает их в буфер и разбирает целые кадры.
 void NetworkManager::onReadyRead()
 {
-    QDataStream in(m_socket);
-    in.setVersion(QDataStream::Qt_5_15);
-
-    // Цикл на случай, если пришло несколько сообщений сразу.
-    while (!in.atEnd()) {
-        quint8 msgTypeRaw;
-        in >> msgTypeRaw;
-        MessageType msgType = static_cast<MessageType>(msgTypeRaw);
-
-        if (msgType == MsgMove) {
-            quint8 fromRow, fromCol, toRow, toCol, promotionPiece;
-            in >> fromRow >> fromCol >> toRow >> toCol >> promotionPiece;
+    while (m_socket->bytesAvailable() > 0) {
+        int free = m_receiveBuffer.size() - m_receivedBytes;
+        if (free == 0) {
+            if (m_paused) return;  // Остальное дочитаем из сокета в resume().
+            // Буфер вмещает кадр наибольшей длины; заполнен он может быть только
+            // несколькими кадрами подряд — разбираем их и освобождаем место.
+            if (!processFrames()) return;
+            free = m_receiveBuffer.size() - m_receivedBytes;
+        }
+        qint64 read = m_socket->read(m_receiveBuffer.data() + m_receivedBytes, free);
+        if (read <= 0) break;
+        m_receivedBytes += static_cast<int>(read);
+    }
+    processFrames();
+}
 
-            // Собираем структуру Move из полученных данных.
-            Move receivedMove = {static_cast<int>(fromRow), static_cast<int>(fromCol),
-                                 static_cast<int>(toRow),   static_cast<int>(toCol),
-                                 static_cast<PieceType>(promotionPiece)};
-            // Уведомляем остальную часть программы о полученном ходе.
-            emit moveReceived(receivedMove);
-        } else if (msgType == MsgChat) {
-            QString text;
-            in >> text;
-            emit chatReceived(text);
-        } else {
-            // Неизвестный тип — прекращаем чтение, чтобы не «сломать» поток.
-            break;
+bool NetworkManager::processFrames()
+{
+    const char* data = m_receiveBuffer.constData();
+    int offset = 0;
+    while (!m_paused && m_receivedBytes - offset >= HeaderSize) {
+        int size = qFromBigEndian<quint16>(data + offset);
+        if (size > MaxPayloadSize) {
+            // Поток рассинхронизирован или собеседник говорит на другом протоколе.
+            m_receivedBytes = 0;
+            m_socket->abort();
+            return false;
+        }
+        if (m_receivedBytes - offset < HeaderSize + size) break;  // Кадр пришел не целиком.
+        bool valid = handleFrame(static_cast<quint8>(data[offset + 2]), data + offset + HeaderSize, size);
+        offset += HeaderSize + size;
+        if (!valid) {
+            m_receivedBytes = 0;
+            m_socket->abort();
+            return false;
         }
     }
+    // Начало недочитанного кадра переносится в начало буфера.
+    if (offset > 0) {
+        std::memmove(m_receiveBuffer.data(), m_receiveBuffer.constData() + offset, m_receivedBytes - offset);
+        m_receivedBytes -= offset;
+    }
+    return true;
+}
+
+bool NetworkManager::handleFrame(quint8 type, const char* payload, int size)
+{
+    if (type == MsgMove) {
+        if (size != 2) return false;
+        // Уведомляем остальную часть программы о полученном ходе.
+        emit moveReceived(unpackMove(static_cast<PackedMove>(qFromBigEndian<quint16>(payload))));
+    } else if (type == MsgChat) {
+        if (size % 2 != 0) return false;  // UTF-16: по два байта на символ.
+        QString text(size / 2, Qt::Uninitialized);
+        qFromBigEndian<quint16>(payload, size / 2, text.data());
+        emit chatReceived(text);
+    } else if (type == MsgHello) {
+        // Приветствие другой версии или с недопустимой позицией: играть по нему нельзя.
+        GameHello hello;
+        if (!decodeGameHello(reinterpret_cast<const uint8_t*>(payload), size, hello)) return false;
+        m_paused = true;
+        emit helloReceived(hello);
+    }
+    // Кадры неизвестного типа (от более новой версии) пропускаются: длина известна из заголовка.
+    return true;
 }
 
 // Вызывается при изменении состояния сокета.
@@ -2,7 +2,9 @@
 #define NETWORKMANAGER_H
 
 #include <QObject>
+#include <QByteArray>
 #include "piece_logic.h"
+#include "game_hello.h"
 
 class QTcpSocket;
 
@@ -12,6 +14,17 @@ class QTcpSocket;
  *
  * Отвечает за сериализацию, отправку, получение и десериализацию
  * игровых данных (ходов) через TCP сокет, а также обмен сообщениями чата.
+ *
+ * Протокол — поток кадров: заголовок из длины данных (quint16) и типа (quint8),
+ * затем данные; все числа — big-endian. TCP не сохраняет границ сообщений, поэтому
+ * принятые байты копятся в буфере, и кадр разбирается, только когда пришел целиком:
+ * кадр, разрезанный на несколько сегментов, и несколько кадров в одном сегменте
+ * читаются одинаково. Кадры неизвестного типа пропускаются по длине, кадр длиннее
+ * MaxPayloadSize считается нарушением протокола и разрывает соединение.
+ *
+ * Первый кадр от хоста — приветствие (game_hello.h) со стартовой позицией. Приняв его,
+ * менеджер приостанавливает разбор до resume(): следующие кадры (например, первый
+ * ход хоста) ждут в буфере, пока игровое окно не подпишется на сигналы.
  */
 class NetworkManager : public QObject
 {
@@ -24,9 +37,18 @@ public:
     // Отправляет ход (включая информацию о превращении) оппоненту.
     void sendMove(const Move& move);
 
-    // Отправляет текстовое сообщение чата оппоненту.
+    // Отправляет текстовое сообщение чата оппоненту (не длиннее MaxChatLength символов).
     void sendChatMessage(const QString &message);
 
+    // Отправляет приветствие со стартовой позицией (хост — клиенту).
+    void sendHello(const GameHello& hello);
+    // Продолжает разбор кадров, приостановленный после приветствия.
+    void resume();
+
+    static constexpr int HeaderSize = 3;        // Длина данных (2 байта) и тип (1 байт).
+    static constexpr int MaxPayloadSize = 4096;
+    static constexpr int MaxChatLength = MaxPayloadSize / 2; // Чат передается в UTF-16.
+
 signals:
     // Сигнал, испускаемый при получении хода от оппонента.
     void moveReceived(const Move& move);
@@ -34,6 +56,8 @@ signals:
     void opponentDisconnected();
     // Сигнал при получении сообщения чата.
     void chatReceived(const QString &message);
+    // Сигнал при получении приветствия хоста; после него разбор приостановлен до resume().
+    void helloReceived(const GameHello& hello);
 
 private slots:
     // Внутренние слоты для обработки событий сокета.
@@ -41,13 +65,24 @@ private slots:
     void onSocketStateChanged();
 
 private:
-    QTcpSocket* m_socket;
-
     // Простой бинарный протокол.
     enum MessageType : quint8 {
-        MsgMove = 0,   // Ход.
-        MsgChat = 1    // Сообщение чата (QString).
+        MsgMove = 0,   // Ход: PackedMove (quint16).
+        MsgChat = 1,   // Сообщение чата: символы UTF-16.
+        MsgHello = 2   // Приветствие: HelloSize байт (game_hello.h).
     };
+
+    void writeFrame(MessageType type, const char* payload, int size);
+    // Разбирает все целые кадры в начале буфера; false — нарушение протокола.
+    bool processFrames();
+    // false — кадр известного типа с недопустимым содержимым.
+    bool handleFrame(quint8 type, const char* payload, int size);
+
+    QTcpSocket* m_socket;
+    QByteArray m_receiveBuffer;   // Принятые, но еще не разобранные байты (память переиспользуется).
+    int m_receivedBytes = 0;
+    bool m_paused = false;        // Разбор остановлен после приветствия.
+    QByteArray m_sendBuffer;      // Данные кадра чата в сетевом порядке байт (переиспользуется).
 };
 
 #endif // NETWORKMANAGER_H
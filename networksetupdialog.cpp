@@ -1,5 +1,6 @@
 #include "networksetupdialog.h"
 #include "piece_logic.h"
+#include "networkmanager.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -10,7 +11,6 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QNetworkInterface>
-#include <QDataStream>
 #include <QHostAddress>
 
 NetworkSetupDialog::NetworkSetupDialog(QWidget *parent)
@@ -21,7 +21,7 @@ NetworkSetupDialog::NetworkSetupDialog(QWidget *parent)
     setMinimumSize(400, 200);
 }
 
-NetworkSetupDialog::~NetworkSetupDialog() {}
+NetworkSetupDialog::~NetworkSetupDialog() { delete m_networkManager; }
 
 // Инициализация интерфейса диалогового окна.
 void NetworkSetupDialog::setupUI() {
@@ -88,7 +88,6 @@ void NetworkSetupDialog::joinGame() {
 
     m_socket = new QTcpSocket(this);
     connect(m_socket, &QTcpSocket::connected, this, &NetworkSetupDialog::onConnected);
-    connect(m_socket, &QTcpSocket::readyRead, this, &NetworkSetupDialog::onReadyRead);
     connect(m_socket, &QAbstractSocket::stateChanged, this, &NetworkSetupDialog::onSocketStateChanged);
 
     m_statusLabel->setText("Подключение к " + ipAddress + "...");
@@ -99,7 +98,6 @@ void NetworkSetupDialog::joinGame() {
 void NetworkSetupDialog::onNewConnection() {
     m_socket = m_server->nextPendingConnection();
     if (!m_socket) return;
-    connect(m_socket, &QTcpSocket::readyRead, this, &NetworkSetupDialog::onReadyRead);
     connect(m_socket, &QAbstractSocket::stateChanged, this, &NetworkSetupDialog::onSocketStateChanged);
     m_server->close(); // Больше не принимаем подключения.
     m_statusLabel->setText("Оппонент подключен! Настройка игры...");
@@ -107,60 +105,35 @@ void NetworkSetupDialog::onNewConnection() {
     // Хост всегда играет белыми.
     m_playerColor = WHITE;
     // Хост генерирует расстановку и отправляет ее Клиенту.
-    sendInitialData(m_socket);
+    m_networkManager = new NetworkManager(m_socket);
+    sendInitialData();
 
     // Все готово, закрываем диалог с успехом.
     accept();
 }
 
 // Хост генерирует и отправляет данные для начала игры.
-void NetworkSetupDialog::sendInitialData(QTcpSocket* clientSocket) {
-    // Генерируем уникальную позицию Chess960.
+void NetworkSetupDialog::sendInitialData() {
+    // Генерируем уникальную позицию Chess960. Ее номер известен, поэтому доска
+    // не передается: Клиент расставит ту же позицию (с теми же вертикалями рокировки) сам.
     PieceLogic tempLogic;
-    std::array<Piece, 64> boardState;
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            boardState[i * 8 + j] = tempLogic.getPieceAt(i, j);
-        }
-    }
-    // Сериализуем доску в строку для отправки.
-    QString layoutStr;
-    QTextStream stream(&layoutStr);
-    for(const auto& piece : boardState) {
-        stream << static_cast<int>(piece.type) << "," << static_cast<int>(piece.color) << ";";
-    }
-    m_initialBoardLayout = layoutStr;
-
-    // Отправляем данные клиенту: расстановку и его цвет (черный).
-    QByteArray block;
-    QDataStream out(&block, QIODevice::WriteOnly);
-    out.setVersion(QDataStream::Qt_5_15);
-    out << layoutStr << static_cast<quint8>(BLACK);
-
-    clientSocket->write(block);
+    m_hello = makeGameHello(tempLogic.game().position(), tempLogic.getStartPositionIndex(), BLACK);
+    m_networkManager->sendHello(m_hello);
 }
 
 // Слот для Клиента: успешно подключились к Хосту.
 void NetworkSetupDialog::onConnected() {
     m_statusLabel->setText("Соединение установлено!\nОжидание данных от хоста...");
+    m_networkManager = new NetworkManager(m_socket);
+    connect(m_networkManager, &NetworkManager::helloReceived, this, &NetworkSetupDialog::onHelloReceived);
 }
 
-// Слот для Клиента: получили данные от Хоста.
-void NetworkSetupDialog::onReadyRead() {
-    if (m_isHost) return;
-
-    QDataStream in(m_socket);
-    in.setVersion(QDataStream::Qt_5_15);
-
-    // Читаем расстановку и наш цвет.
-    quint8 color;
-    in >> m_initialBoardLayout >> color;
-    m_playerColor = static_cast<PieceColor>(color);
-
-    if (!m_initialBoardLayout.isEmpty()) {
-        m_statusLabel->setText("Данные получены! Игра начинается.");
-        accept(); // Все готово.
-    }
+// Слот для Клиента: получили приветствие Хоста.
+void NetworkSetupDialog::onHelloReceived(const GameHello& hello) {
+    m_hello = hello;
+    m_playerColor = hello.receiverColor;
+    m_statusLabel->setText("Данные получены! Игра начинается.");
+    accept(); // Все готово.
 }
 
 // Обработка разрыва соединения на этапе настройки.
@@ -185,6 +158,11 @@ QString NetworkSetupDialog::findMyIp() const {
 }
 
 // Геттеры.
-QTcpSocket* NetworkSetupDialog::getSocket() const { return m_socket; }
-QString NetworkSetupDialog::getInitialBoardLayout() const { return m_initialBoardLayout; }
+NetworkManager* NetworkSetupDialog::takeNetworkManager() {
+    NetworkManager* manager = m_networkManager;
+    if (manager) disconnect(manager, nullptr, this, nullptr);
+    m_networkManager = nullptr;
+    return manager;
+}
+GameHello NetworkSetupDialog::getHello() const { return m_hello; }
 PieceColor NetworkSetupDialog::getPlayerColor() const { return m_playerColor; }
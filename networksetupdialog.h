@@ -4,8 +4,10 @@
 #include <QDialog>
 #include <QAbstractSocket>
 #include "piece_logic.h"
+#include "game_hello.h"
 
 // Предварительные объявления
+class NetworkManager;
 class QTcpServer;
 class QTcpSocket;
 class QPushButton;
@@ -17,8 +19,9 @@ class QLabel;
  * @brief Диалог для установки P2P-соединения.
  *
  * Предоставляет пользователю выбор: создать игру (Хост) или подключиться (Клиент).
- * Выполняет "рукопожатие": Хост генерирует расстановку и отправляет ее Клиенту.
- * После успешного завершения предоставляет готовый сокет и параметры игры.
+ * Выполняет "рукопожатие": Хост генерирует расстановку и отправляет ее Клиенту
+ * бинарным приветствием (game_hello.h). После успешного завершения предоставляет
+ * готовый NetworkManager и параметры игры.
  */
 class NetworkSetupDialog : public QDialog
 {
@@ -29,8 +32,9 @@ public:
     ~NetworkSetupDialog();
 
     // Геттеры для получения результата работы диалога.
-    QTcpSocket* getSocket() const;
-    QString getInitialBoardLayout() const;
+    // Передает NetworkManager вызывающему; без этого он удаляется вместе с диалогом.
+    NetworkManager* takeNetworkManager();
+    GameHello getHello() const;
     PieceColor getPlayerColor() const;
 
 private slots:
@@ -41,17 +45,18 @@ private slots:
     // Слоты для обработки сетевых событий.
     void onNewConnection();      // Для Хоста: когда Клиент подключился.
     void onConnected();          // Для Клиента: когда он подключился к Хосту.
-    void onReadyRead();          // Для Клиента: получение данных от Хоста.
+    void onHelloReceived(const GameHello& hello); // Для Клиента: получено приветствие Хоста.
     void onSocketStateChanged(QAbstractSocket::SocketState socketState);
 
 private:
     void setupUI();
-    void sendInitialData(QTcpSocket* clientSocket); // Хост отправляет стартовые данные.
+    void sendInitialData(); // Хост отправляет стартовые данные.
     QString findMyIp() const; // Поиск локального IP для удобства.
 
     // Сетевые объекты
     QTcpServer* m_server = nullptr;
     QTcpSocket* m_socket = nullptr;
+    NetworkManager* m_networkManager = nullptr; // Создается на установленном сокете.
 
     // Элементы интерфейса
     QPushButton* m_hostButton;
@@ -61,7 +66,7 @@ private:
     QLabel* m_infoLabel;
 
     // Данные игры для обмена
-    QString m_initialBoardLayout; // Строка с расстановкой фигур.
+    GameHello m_hello;            // Стартовая позиция и цвет Клиента.
     PieceColor m_playerColor;     // Цвет, которым будет играть этот игрок.
     bool m_isHost;                // Флаг роли этого игрока.
 };
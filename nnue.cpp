@@ -0,0 +1,316 @@
+#include "nnue.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define NNUE_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC и Clang компилируют функцию под набор инструкций без флагов на весь файл;
+// MSVC разрешает интринсики и так.
+#if defined(__GNUC__)
+#define NNUE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NNUE_TARGET(isa)
+#endif
+
+namespace Nnue {
+
+namespace {
+
+const char FileMagic[4] = { 'C', '9', 'N', 'N' };
+const uint32_t FileVersion = 1;
+
+// dst = src + сумма столбцов added - сумма столбцов removed (HiddenSize значений).
+using AddSubKernel = void (*)(int16_t* dst, const int16_t* src,
+                              const int16_t* const* added, int addedCount,
+                              const int16_t* const* removed, int removedCount);
+// Сумма clamp(us[i], 0, QA) * weights[i] + clamp(them[i], 0, QA) * weights[HiddenSize + i].
+using OutputKernel = int32_t (*)(const int16_t* us, const int16_t* them, const int16_t* weights);
+
+void addSubScalar(int16_t* dst, const int16_t* src, const int16_t* const* added, int addedCount,
+                  const int16_t* const* removed, int removedCount) {
+    for (int i = 0; i < HiddenSize; ++i) {
+        int value = src[i];
+        for (int a = 0; a < addedCount; ++a) value += added[a][i];
+        for (int r = 0; r < removedCount; ++r) value -= removed[r][i];
+        dst[i] = static_cast<int16_t>(value);
+    }
+}
+
+int32_t outputScalar(const int16_t* us, const int16_t* them, const int16_t* weights) {
+    int32_t sum = 0;
+    for (int i = 0; i < HiddenSize; ++i) {
+        sum += std::clamp<int>(us[i], 0, ActivationMax) * weights[i];
+        sum += std::clamp<int>(them[i], 0, ActivationMax) * weights[HiddenSize + i];
+    }
+    return sum;
+}
+
+#ifdef NNUE_X86
+
+NNUE_TARGET("sse4.1")
+void addSubSse41(int16_t* dst, const int16_t* src, const int16_t* const* added, int addedCount,
+                 const int16_t* const* removed, int removedCount) {
+    for (int i = 0; i < HiddenSize; i += 8) {
+        __m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(src + i));
+        for (int a = 0; a < addedCount; ++a)
+            value = _mm_add_epi16(value, _mm_load_si128(reinterpret_cast<const __m128i*>(added[a] + i)));
+        for (int r = 0; r < removedCount; ++r)
+            value = _mm_sub_epi16(value, _mm_load_si128(reinterpret_cast<const __m128i*>(removed[r] + i)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    }
+}
+
+NNUE_TARGET("sse4.1")
+int32_t horizontalSum(__m128i sum) {
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+NNUE_TARGET("sse4.1")
+int32_t outputSse41(const int16_t* us, const int16_t* them, const int16_t* weights) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi16(ActivationMax);
+    __m128i sum = zero;
+    for (int i = 0; i < HiddenSize; i += 8) {
+        __m128i a = _mm_min_epi16(_mm_max_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(us + i)), zero), max);
+        __m128i b = _mm_min_epi16(_mm_max_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(them + i)), zero), max);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, _mm_load_si128(reinterpret_cast<const __m128i*>(weights + i))));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(b, _mm_load_si128(reinterpret_cast<const __m128i*>(weights + HiddenSize + i))));
+    }
+    return horizontalSum(sum);
+}
+
+NNUE_TARGET("avx2")
+void addSubAvx2(int16_t* dst, const int16_t* src, const int16_t* const* added, int addedCount,
+                const int16_t* const* removed, int removedCount) {
+    for (int i = 0; i < HiddenSize; i += 16) {
+        __m256i value = _mm256_load_si256(reinterpret_cast<const __m256i*>(src + i));
+        for (int a = 0; a < addedCount; ++a)
+            value = _mm256_add_epi16(value, _mm256_load_si256(reinterpret_cast<const __m256i*>(added[a] + i)));
+        for (int r = 0; r < removedCount; ++r)
+            value = _mm256_sub_epi16(value, _mm256_load_si256(reinterpret_cast<const __m256i*>(removed[r] + i)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), value);
+    }
+}
+
+NNUE_TARGET("avx2")
+int32_t outputAvx2(const int16_t* us, const int16_t* them, const int16_t* weights) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(ActivationMax);
+    __m256i sum = zero;
+    for (int i = 0; i < HiddenSize; i += 16) {
+        __m256i a = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(us + i)), zero), max);
+        __m256i b = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(them + i)), zero), max);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i))));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(b, _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + HiddenSize + i))));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    return horizontalSum(half);
+}
+
+#endif // NNUE_X86
+
+std::unique_ptr<Network> CurrentNetwork;
+SimdLevel CurrentLevel = SIMD_SCALAR;
+AddSubKernel AddSub = addSubScalar;
+OutputKernel Output = outputScalar;
+
+// Ядра выбираются до main(), как и таблицы атак.
+struct KernelInit {
+    KernelInit() { setSimdLevel(bestSimdLevel()); }
+} kernelInit;
+
+bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// Номер признака: фигура относительно стороны perspective (0 — белые, 1 — черные).
+// Для черных доска отражается по вертикали, а «свои» и «чужие» меняются местами.
+int featureIndex(int perspective, Piece piece, int square) {
+    int relativeColor = ((piece.color == WHITE) == (perspective == 0)) ? 0 : 1;
+    int relativeSquare = (perspective == 0) ? square : (square ^ 56);
+    return relativeColor * 384 + (piece.type - 1) * 64 + relativeSquare;
+}
+
+} // namespace
+
+bool loadNetwork(const std::string& path, std::string* error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return fail(error, "cannot open " + path);
+
+    char magic[4];
+    uint32_t version = 0, hiddenSize = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&hiddenSize), sizeof(hiddenSize));
+    if (!in || std::memcmp(magic, FileMagic, sizeof(magic)) != 0) return fail(error, "not a Chess960 network file");
+    if (version != FileVersion) return fail(error, "unsupported network version " + std::to_string(version));
+    if (hiddenSize != HiddenSize) return fail(error, "hidden layer size " + std::to_string(hiddenSize) + " does not match " + std::to_string(HiddenSize));
+
+    std::unique_ptr<Network> network(new Network);
+    in.read(reinterpret_cast<char*>(network->featureWeights), sizeof(network->featureWeights));
+    in.read(reinterpret_cast<char*>(network->featureBias), sizeof(network->featureBias));
+    in.read(reinterpret_cast<char*>(network->outputWeights), sizeof(network->outputWeights));
+    in.read(reinterpret_cast<char*>(&network->outputBias), sizeof(network->outputBias));
+    if (!in) return fail(error, "truncated network file");
+    if (in.peek() != std::ifstream::traits_type::eof()) return fail(error, "unexpected data after the network");
+
+    CurrentNetwork = std::move(network);
+    return true;
+}
+
+bool saveNetwork(const std::string& path, std::string* error) {
+    if (!CurrentNetwork) return fail(error, "no network loaded");
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return fail(error, "cannot create " + path);
+    uint32_t version = FileVersion, hiddenSize = HiddenSize;
+    out.write(FileMagic, sizeof(FileMagic));
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&hiddenSize), sizeof(hiddenSize));
+    out.write(reinterpret_cast<const char*>(CurrentNetwork->featureWeights), sizeof(CurrentNetwork->featureWeights));
+    out.write(reinterpret_cast<const char*>(CurrentNetwork->featureBias), sizeof(CurrentNetwork->featureBias));
+    out.write(reinterpret_cast<const char*>(CurrentNetwork->outputWeights), sizeof(CurrentNetwork->outputWeights));
+    out.write(reinterpret_cast<const char*>(&CurrentNetwork->outputBias), sizeof(CurrentNetwork->outputBias));
+    if (!out) return fail(error, "write error: " + path);
+    return true;
+}
+
+void setRandomNetwork(uint32_t seed) {
+    // Первые MaterialNeurons нейронов считают материал своей стороны, остальные — шум.
+    // С такой сетью поиск ведет себя правдоподобно: чистый шум без материала не дает
+    // оценке «стоя на месте» отсекать, и форсированный перебор взятий разрастается.
+    // Веса малы, чтобы сумма 32 фигур гарантированно помещалась в int16.
+    const int MaterialNeurons = 16;
+    const int MaterialOutputWeight = 42;                              // 6 единиц (пешка) ~ 100 сотых.
+    const int PieceMaterial[7] = { 0, 0, 54, 30, 20, 20, 6 };         // Сумма одной стороны < ActivationMax.
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> feature(-8, 8), bias(-32, 32), output(-4, 4);
+    std::unique_ptr<Network> network(new Network);
+    for (int index = 0; index < FeatureCount; ++index) {
+        bool own = index < FeatureCount / 2;
+        int type = (index % 384) / 64 + 1;
+        for (int i = 0; i < HiddenSize; ++i) {
+            network->featureWeights[index][i] = static_cast<int16_t>(
+                i < MaterialNeurons ? (own ? PieceMaterial[type] : 0) : feature(random));
+        }
+    }
+    for (int i = 0; i < HiddenSize; ++i) {
+        network->featureBias[i] = static_cast<int16_t>(i < MaterialNeurons ? 0 : bias(random));
+        network->outputWeights[0][i] = static_cast<int16_t>(i < MaterialNeurons ? MaterialOutputWeight : output(random));
+        network->outputWeights[1][i] = static_cast<int16_t>(i < MaterialNeurons ? -MaterialOutputWeight : output(random));
+    }
+    network->outputBias = 0;
+    CurrentNetwork = std::move(network);
+}
+
+void unloadNetwork() { CurrentNetwork.reset(); }
+bool isLoaded() { return CurrentNetwork != nullptr; }
+const Network& network() { return *CurrentNetwork; }
+
+SimdLevel bestSimdLevel() {
+#ifdef NNUE_X86
+    if (cpuHasAvx2()) return SIMD_AVX2;
+    if (cpuHasSse41()) return SIMD_SSE41;
+#endif
+    return SIMD_SCALAR;
+}
+
+SimdLevel simdLevel() { return CurrentLevel; }
+
+bool setSimdLevel(SimdLevel level) {
+    if (level > bestSimdLevel()) return false;
+    switch (level) {
+#ifdef NNUE_X86
+    case SIMD_AVX2:  AddSub = addSubAvx2;  Output = outputAvx2;  break;
+    case SIMD_SSE41: AddSub = addSubSse41; Output = outputSse41; break;
+#endif
+    default:         AddSub = addSubScalar; Output = outputScalar; break;
+    }
+    CurrentLevel = level;
+    return true;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SIMD_AVX2:  return "avx2";
+    case SIMD_SSE41: return "sse4.1";
+    default:         return "scalar";
+    }
+}
+
+void refreshAccumulator(const Position& position, Accumulator& accumulator) {
+    const Network& net = *CurrentNetwork;
+    const int16_t* columns[2][32] = {};
+    int count = 0;
+    Bitboard pieces = position.occupied();
+    while (pieces && count < 32) {
+        int square = popLsb(pieces);
+        Piece piece = position.pieceAt(square);
+        columns[0][count] = net.featureWeights[featureIndex(0, piece, square)];
+        columns[1][count] = net.featureWeights[featureIndex(1, piece, square)];
+        ++count;
+    }
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        AddSub(accumulator.values[perspective], net.featureBias, columns[perspective], count, nullptr, 0);
+    }
+    // Больше 32 фигур бывает только в искусственных позициях: досчитываем по одной.
+    while (pieces) {
+        int square = popLsb(pieces);
+        Piece piece = position.pieceAt(square);
+        for (int perspective = 0; perspective < 2; ++perspective) {
+            const int16_t* column = net.featureWeights[featureIndex(perspective, piece, square)];
+            AddSub(accumulator.values[perspective], accumulator.values[perspective], &column, 1, nullptr, 0);
+        }
+    }
+}
+
+void updateAccumulator(const Accumulator& before, Accumulator& after,
+                       const Position& afterPosition, PackedMove move, const UndoInfo& undo) {
+    struct Feature { Piece piece; int square; };
+    Feature added[2], removed[2];
+    int addedCount = 0, removedCount = 0;
+
+    int from = moveFrom(move), to = moveTo(move);
+    if (undo.isCastling) {
+        // Ход записан как «король берет свою ладью»: обе фигуры встают на итоговые клетки.
+        bool isShortCastle = squareCol(to) > squareCol(from);
+        int row = squareRow(from);
+        Piece rook = {ROOK, undo.moved.color};
+        removed[removedCount++] = {undo.moved, from};
+        removed[removedCount++] = {rook, to};
+        added[addedCount++] = {undo.moved, makeSquare(row, isShortCastle ? 6 : 2)};
+        added[addedCount++] = {rook, makeSquare(row, isShortCastle ? 5 : 3)};
+    } else {
+        removed[removedCount++] = {undo.moved, from};
+        added[addedCount++] = {afterPosition.pieceAt(to), to}; // С учетом превращения.
+        if (undo.captured.type != NONE) removed[removedCount++] = {undo.captured, undo.capturedSquare};
+    }
+
+    const Network& net = *CurrentNetwork;
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        const int16_t* addedColumns[2];
+        const int16_t* removedColumns[2];
+        for (int i = 0; i < addedCount; ++i)
+            addedColumns[i] = net.featureWeights[featureIndex(perspective, added[i].piece, added[i].square)];
+        for (int i = 0; i < removedCount; ++i)
+            removedColumns[i] = net.featureWeights[featureIndex(perspective, removed[i].piece, removed[i].square)];
+        AddSub(after.values[perspective], before.values[perspective], addedColumns, addedCount, removedColumns, removedCount);
+    }
+}
+
+int evaluate(const Accumulator& accumulator, PieceColor sideToMove) {
+    const Network& net = *CurrentNetwork;
+    int us = (sideToMove == WHITE) ? 0 : 1;
+    int32_t sum = Output(accumulator.values[us], accumulator.values[us ^ 1], net.outputWeights[0]);
+    return static_cast<int>((static_cast<int64_t>(sum) + net.outputBias) * OutputScale / (ActivationMax * WeightScale));
+}
+
+} // namespace Nnue
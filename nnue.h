@@ -0,0 +1,77 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "position.h"
+#include <cstdint>
+#include <string>
+
+/*
+ * Оценка нейросетью с эффективно обновляемым первым слоем (NNUE), только CPU.
+ *
+ * Архитектура 768 -> 2x256 -> 1. Признаки — фигура (цвет, тип) на клетке,
+ * с точки зрения каждой из сторон: для черных доска отражается, а цвета меняются
+ * местами. Первый слой (аккумулятор, int16) при ходе не пересчитывается, а
+ * обновляется: вычитаются столбцы весов исчезнувших признаков, прибавляются
+ * появившиеся (не больше двух тех и других). Выход — скалярное произведение
+ * аккумуляторов стороны, которой ходить, и соперника после ограничения [0, QA]
+ * с весами выходного слоя.
+ *
+ * Ядра (сложение столбцов, выходной слой) есть в трех вариантах — AVX2, SSE4.1
+ * и переносимый скалярный; лучший доступный выбирается при запуске.
+ *
+ * Формат файла весов (little-endian):
+ *   char[4]  "C9NN"
+ *   uint32   версия (1)
+ *   uint32   размер скрытого слоя (HiddenSize)
+ *   int16    featureWeights[FeatureCount][HiddenSize]
+ *   int16    featureBias[HiddenSize]
+ *   int16    outputWeights[2][HiddenSize]   (сначала сторона, которой ходить)
+ *   int32    outputBias
+ */
+namespace Nnue {
+
+constexpr int FeatureCount = 768;
+constexpr int HiddenSize = 256;
+constexpr int ActivationMax = 255;    // QA: верхняя граница активации первого слоя.
+constexpr int OutputScale = 400;      // Перевод выхода сети в сотые пешки.
+constexpr int WeightScale = 64;       // QB: масштаб весов выходного слоя.
+
+struct alignas(64) Network {
+    int16_t featureWeights[FeatureCount][HiddenSize];
+    int16_t featureBias[HiddenSize];
+    int16_t outputWeights[2][HiddenSize];
+    int32_t outputBias;
+};
+
+// Первый слой для обеих сторон: [0] — с точки зрения белых, [1] — черных.
+struct alignas(64) Accumulator {
+    int16_t values[2][HiddenSize];
+};
+
+enum SimdLevel { SIMD_SCALAR = 0, SIMD_SSE41 = 1, SIMD_AVX2 = 2 };
+
+// Загружает веса; при ошибке сеть не меняется, error получает описание.
+bool loadNetwork(const std::string& path, std::string* error = nullptr);
+bool saveNetwork(const std::string& path, std::string* error = nullptr);
+// Детерминированная сеть «материал плюс случайный шум» — для замеров скорости и проверок ядер.
+void setRandomNetwork(uint32_t seed);
+void unloadNetwork();
+bool isLoaded();
+const Network& network();
+
+SimdLevel bestSimdLevel();                // Лучшие ядра, которые поддерживает процессор.
+SimdLevel simdLevel();                    // Текущие ядра.
+bool setSimdLevel(SimdLevel level);       // false, если процессор их не поддерживает.
+const char* simdLevelName(SimdLevel level);
+
+// Полный пересчет первого слоя по позиции.
+void refreshAccumulator(const Position& position, Accumulator& accumulator);
+// Инкрементальное обновление после makeMove: after — позиция после хода.
+void updateAccumulator(const Accumulator& before, Accumulator& after,
+                       const Position& afterPosition, PackedMove move, const UndoInfo& undo);
+// Оценка в сотых пешки с точки зрения стороны, которой ходить.
+int evaluate(const Accumulator& accumulator, PieceColor sideToMove);
+
+} // namespace Nnue
+
+#endif // NNUE_H
@@ -0,0 +1,124 @@
+#include "opening_book.h"
+#include "movegen.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char FileMagic[4] = { 'C', '9', 'B', 'K' };
+const uint32_t FileVersion = 1;
+const int MaxBookMoves = 64;
+
+bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+} // namespace
+
+bool OpeningBook::open(const std::string& path, std::string* error) {
+    close();
+    // Двоичный поиск читает страницы вразброс: упреждающее чтение только мешает.
+    if (!m_file.open(path, true, error)) return false;
+    m_data = m_file.data();
+
+    if (m_file.size() < HeaderSize || std::memcmp(m_data, FileMagic, sizeof(FileMagic)) != 0) {
+        close();
+        return fail(error, "not an opening book: " + path);
+    }
+    if (readLittleEndian(m_data + 4, 4) != FileVersion) {
+        close();
+        return fail(error, "unsupported opening book version");
+    }
+    uint64_t count = readLittleEndian(m_data + 8, 8);
+    if (count > (m_file.size() - HeaderSize) / EntrySize || HeaderSize + count * EntrySize != m_file.size()) {
+        close();
+        return fail(error, "truncated opening book: " + path);
+    }
+    m_count = static_cast<size_t>(count);
+    return true;
+}
+
+void OpeningBook::close() {
+    m_file.close();
+    m_data = nullptr;
+    m_count = 0;
+}
+
+uint64_t OpeningBook::keyAt(size_t index) const {
+    return readLittleEndian(m_data + HeaderSize + index * EntrySize, 8);
+}
+
+BookEntry OpeningBook::entryAt(size_t index) const {
+    const unsigned char* record = m_data + HeaderSize + index * EntrySize;
+    BookEntry entry;
+    entry.key = readLittleEndian(record, 8);
+    entry.move = static_cast<PackedMove>(readLittleEndian(record + 8, 2));
+    entry.weight = static_cast<uint16_t>(readLittleEndian(record + 10, 2));
+    entry.games = static_cast<uint16_t>(readLittleEndian(record + 12, 2));
+    entry.points = static_cast<uint16_t>(readLittleEndian(record + 14, 2));
+    return entry;
+}
+
+int OpeningBook::probe(uint64_t key, BookEntry* entries, int maxEntries) const {
+    // Первая запись с ключом не меньше key.
+    size_t low = 0, high = m_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (keyAt(middle) < key) low = middle + 1;
+        else high = middle;
+    }
+    int found = 0;
+    for (size_t index = low; index < m_count && found < maxEntries && keyAt(index) == key; ++index) {
+        entries[found++] = entryAt(index);
+    }
+    return found;
+}
+
+PackedMove OpeningBook::chooseMove(const Position& position, uint32_t random) const {
+    BookEntry entries[MaxBookMoves];
+    int count = probe(position.key(), entries, MaxBookMoves);
+    if (count == 0) return NullMove;
+
+    // Хеш мог совпасть случайно: берутся только легальные в этой позиции ходы.
+    MoveList legal;
+    generateLegalMoves(position, legal);
+    uint32_t totalWeight = 0;
+    for (int i = 0; i < count; ++i) {
+        if (std::find(legal.begin(), legal.end(), entries[i].move) == legal.end()) entries[i].weight = 0;
+        totalWeight += entries[i].weight;
+    }
+    if (totalWeight == 0) return NullMove;
+
+    uint32_t pick = random % totalWeight;
+    for (int i = 0; i < count; ++i) {
+        if (pick < entries[i].weight) return entries[i].move;
+        pick -= entries[i].weight;
+    }
+    return NullMove;
+}
+
+bool OpeningBook::write(const std::string& path, const BookEntry* entries, size_t count, std::string* error) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return fail(error, "cannot create " + path);
+
+    unsigned char header[HeaderSize];
+    std::memcpy(header, FileMagic, sizeof(FileMagic));
+    writeLittleEndian(header + 4, FileVersion, 4);
+    writeLittleEndian(header + 8, count, 8);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    unsigned char record[EntrySize];
+    for (size_t i = 0; i < count; ++i) {
+        writeLittleEndian(record, entries[i].key, 8);
+        writeLittleEndian(record + 8, entries[i].move, 2);
+        writeLittleEndian(record + 10, entries[i].weight, 2);
+        writeLittleEndian(record + 12, entries[i].games, 2);
+        writeLittleEndian(record + 14, entries[i].points, 2);
+        out.write(reinterpret_cast<const char*>(record), sizeof(record));
+    }
+    out.close();
+    if (!out) return fail(error, "cannot write " + path);
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include "mapped_file.h"
+#include "position.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Запись книги: ход из позиции с хешем key. Позиции всех 960 расстановок лежат в одной
+// книге — хеш Зобриста различает их сам.
+struct BookEntry {
+    uint64_t key = 0;
+    PackedMove move = NullMove;   // Рокировка — «король берет ладью», как в PackedMove.
+    uint16_t weight = 0;          // Относительная частота выбора хода.
+    uint16_t games = 0;           // Статистика обучения: партий с этим ходом
+    uint16_t points = 0;          // и набранных в них очков стороной, сделавшей ход (в полуочках).
+};
+
+/**
+ * @class OpeningBook
+ * @brief Дебютная книга в бинарном файле, открытом через mmap.
+ *
+ * Файл не читается в память: он отображается в адресное пространство, и поиск
+ * позиции — двоичный поиск по отсортированным записям, который трогает
+ * log2(N) страниц. Открытие не зависит от размера книги.
+ *
+ * Формат (little-endian):
+ *   char[4]  "C9BK"
+ *   uint32   версия (1)
+ *   uint64   число записей
+ *   записи по 16 байт, по возрастанию key, а при равном key — по убыванию weight:
+ *     uint64 key, uint16 move, uint16 weight, uint16 games, uint16 points
+ *
+ * Книгу строит утилита chess960-book из PGN-архивов.
+ */
+class OpeningBook
+{
+public:
+    static const size_t HeaderSize = 16;
+    static const size_t EntrySize = 16;
+
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    size_t size() const { return m_count; }
+
+    // Записи позиции key (не больше maxEntries, по убыванию веса); возвращает их число.
+    int probe(uint64_t key, BookEntry* entries, int maxEntries) const;
+    // Случайный ход из книги пропорционально весам (random — любое случайное число)
+    // или NullMove, если позиции нет в книге. Ходы проверяются на легальность.
+    PackedMove chooseMove(const Position& position, uint32_t random) const;
+
+    // Запись файла книги; entries должны быть отсортированы как в формате.
+    static bool write(const std::string& path, const BookEntry* entries, size_t count, std::string* error = nullptr);
+
+private:
+    BookEntry entryAt(size_t index) const;
+    uint64_t keyAt(size_t index) const;
+
+    MappedFile m_file;
+    const unsigned char* m_data = nullptr;  // Начало отображения (заголовок).
+    size_t m_count = 0;
+};
+
+#endif // OPENING_BOOK_H
@@ -2,34 +2,19 @@
 #define PIECE_LOGIC_H
 
 #include <QObject>
+#include <QString>
 #include <vector>
 #include <utility>
-#include <array>
-
-// Перечисления для типов фигур, цвета и статуса игры.
-enum PieceType { NONE, KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN };
-enum PieceColor { NO_COLOR, WHITE, BLACK };
-enum GameStatus { IN_PROGRESS, CHECKMATE, STALEMATE };
-
-// Структура, представляющая одну фигуру на доске.
-struct Piece {
-    PieceType type = NONE;
-    PieceColor color = NO_COLOR;
-};
-
-// Структура, представляющая один ход. Включает поле для превращения пешки.
-struct Move {
-    int fromRow, fromCol;
-    int toRow, toCol;
-    PieceType promotion = NONE;
-};
+#include "chess_types.h"
+#include "chess_game.h"
 
 /**
  * @class PieceLogic
- * @brief Игровая логика (Модель). Не зависит от UI и сети.
+ * @brief Игровая логика (Модель) для UI: Qt-обертка над ChessGame.
  *
- * Управляет состоянием доски, проверяет корректность ходов по правилам
- * Chess960, определяет исход игры и хранит историю партии.
+ * Правила, исход игры и история партии реализованы в ChessGame (ядро без Qt).
+ * PieceLogic пересылает вызовы ядру и после каждого изменения доски
+ * испускает boardChanged, по которому сбрасывается кеш легальных ходов и обновляется UI.
  */
 class PieceLogic : public QObject
 {
@@ -39,18 +24,24 @@ public:
     explicit PieceLogic(QObject *parent = nullptr);
 
     // --- Основной API для управления игрой ---
-    void setupNewGame();                    // Начинает новую игру со случайной расстановкой.
+    void setupNewGame(int spIndex = -1);    // Новая игра с позицией по номеру Шарнагля (-1 — случайная).
     bool tryMove(const Move& move);         // Пытается выполнить ход.
-    void setBoardFromLayout(const QString& layout); // Устанавливает доску из строки (для сети).
+    bool undoMove();                        // Отменяет последний ход.
+    void setupFromHello(const GameHello& hello); // Стартовая позиция из приветствия хоста (для сети).
     void forceEndGame();                    // Принудительно завершает игру (для дисконнекта).
+    void setTablebaseAdjudication(bool enabled); // Завершать партию по таблицам эндшпиля.
 
     // --- Методы для получения состояния игры ---
     Piece getPieceAt(int row, int col) const;
     PieceColor getCurrentTurn() const;
     GameStatus getGameStatus() const;
+    PieceColor getWinner() const;           // NO_COLOR — ничья или игра идет.
+    int getStartPositionIndex() const;      // Номер Шарнагля стартовой позиции или -1, если неизвестен.
     const std::vector<Piece>& getCapturedPieces(PieceColor color) const;
     std::vector<Move> getValidMovesForPiece(int row, int col);
     bool isKingInCheck(PieceColor kingColor) const;
+    std::pair<int, int> getKingPosition(PieceColor kingColor) const; // {-1, -1}, если короля нет.
+    const ChessGame& game() const { return m_game; }
 
     // --- Методы для просмотра истории ---
     const Piece* browseHistory(int step);
@@ -62,37 +53,11 @@ signals:
     // Сигнал, который уведомляет UI об изменении состояния доски.
     void boardChanged();
 
-private:
-    // --- Внутреннее состояние игры ---
-    Piece m_board[8][8];
-    PieceColor m_currentTurn;
-    GameStatus m_gameStatus;
-    std::vector<Piece> m_whiteCaptured;
-    std::vector<Piece> m_blackCaptured;
-    bool m_castlingRights[3][2];            // Права на рокировку [цвет][0-длинная, 1-короткая].
-    int m_kingInitialCol[3];                // Исходное положение короля.
-    int m_rookInitialCols[3][2];            // Исходное положение ладей.
-    Move m_lastMove;
-    std::pair<int, int> m_enPassantTargetSquare; // Клетка для взятия на проходе.
-
-    // --- История ---
-    std::vector<std::array<Piece, 64>> m_history;
-    int m_historyBrowserIndex;
+private slots:
+    void invalidateMoveCache();
 
-    // --- Приватные вспомогательные функции ---
-    void generateChess960Position();
-    void switchTurn();
-    void updateGameStatus();
-    bool hasLegalMoves(PieceColor color);
-
-    // Функции валидации ходов
-    bool isMoveValid(const Piece board[8][8], PieceColor turn, const Move& move, bool checkKingSafety = true) const;
-    bool isSquareAttacked(const Piece board[8][8], int row, int col, PieceColor attackerColor) const;
-    bool isKingInCheck(const Piece board[8][8], PieceColor kingColor) const;
-    bool isPawnMoveValid(const Piece board[8][8], const Move& move) const;
-    bool isKnightMoveValid(const Move& move) const;
-    bool isKingMoveValid(const Piece board[8][8], PieceColor turn, const Move& move, bool checkKingSafety = true) const;
-    bool isSlidingMoveValid(const Piece board[8][8], const Move& move, std::initializer_list<std::pair<int, int>> directions) const;
+private:
+    ChessGame m_game;
 };
 
 #endif // PIECE_LOGIC_H
@@ -0,0 +1,507 @@
+#include "position.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+
+Position::Position() {
+    clear();
+}
+
+void Position::clear() {
+    for (Bitboard& b : m_byType) b = 0;
+    for (Bitboard& b : m_byColor) b = 0;
+    for (PackedPiece& p : m_board) p = 0;
+    m_sideToMove = WHITE;
+    m_castlingRights = 0;
+    m_enPassantSquare = -1;
+    m_halfmoveClock = 0;
+    m_fullmoveNumber = 1;
+    m_key = 0;
+    m_psq = EvalScore();
+    m_phase = 0;
+    for (int color = 0; color < 3; ++color) {
+        m_kingInitialCol[color] = -1;
+        m_rookInitialCols[color][LONG_CASTLE] = m_rookInitialCols[color][SHORT_CASTLE] = -1;
+        m_kingSquare[color] = -1;
+        m_attackedBy[color] = 0;
+    }
+    m_checkers = 0;
+    m_pinned = 0;
+}
+
+void Position::putPiece(int square, Piece piece) {
+    if (piece.type == NONE) return;
+    m_byType[piece.type] |= squareBB(square);
+    m_byColor[piece.color] |= squareBB(square);
+    m_board[square] = packPiece(piece);
+    m_key ^= Zobrist::piece(piece, square);
+    m_psq += Psqt::value(piece, square);
+    m_phase += Psqt::PiecePhase[piece.type];
+    if (piece.type == KING) m_kingSquare[piece.color] = square;
+}
+
+void Position::removePiece(int square, Piece piece) {
+    if (piece.type == NONE) return;
+    m_byType[piece.type] ^= squareBB(square);
+    m_byColor[piece.color] ^= squareBB(square);
+    m_board[square] = 0;
+    m_key ^= Zobrist::piece(piece, square);
+    m_psq -= Psqt::value(piece, square);
+    m_phase -= Psqt::PiecePhase[piece.type];
+    if (piece.type == KING) m_kingSquare[piece.color] = -1;
+}
+
+void Position::setSideToMove(PieceColor color) {
+    if (color != m_sideToMove) m_key ^= Zobrist::keys.blackToMove;
+    m_sideToMove = color;
+}
+
+void Position::setEnPassantSquare(int square) {
+    if (m_enPassantSquare != -1) m_key ^= Zobrist::keys.enPassant[squareCol(m_enPassantSquare)];
+    m_enPassantSquare = square;
+    if (m_enPassantSquare != -1) m_key ^= Zobrist::keys.enPassant[squareCol(m_enPassantSquare)];
+}
+
+// Вклад прав на рокировку в хеш: ключ вертикали ладьи для каждого действующего права.
+uint64_t Position::castlingKey(int rights) const {
+    uint64_t key = 0;
+    for (PieceColor color : {WHITE, BLACK}) {
+        for (int side : {LONG_CASTLE, SHORT_CASTLE}) {
+            if (rights & castlingBit(color, side)) key ^= Zobrist::keys.castling[color][m_rookInitialCols[color][side]];
+        }
+    }
+    return key;
+}
+
+void Position::setCastlingRight(PieceColor color, int side, bool allowed) {
+    m_key ^= castlingKey(m_castlingRights);
+    if (allowed) m_castlingRights |= castlingBit(color, side);
+    else m_castlingRights &= ~castlingBit(color, side);
+    m_key ^= castlingKey(m_castlingRights);
+}
+
+void Position::setCastlingFiles(int kingCol, int longRookCol, int shortRookCol) {
+    setCastlingFiles(WHITE, kingCol, longRookCol, shortRookCol);
+    setCastlingFiles(BLACK, kingCol, longRookCol, shortRookCol);
+}
+
+void Position::setCastlingFiles(PieceColor color, int kingCol, int longRookCol, int shortRookCol) {
+    // Ключи прав зависят от вертикалей ладей: снимаем старые права до смены вертикалей.
+    setCastlingRight(color, LONG_CASTLE, false);
+    setCastlingRight(color, SHORT_CASTLE, false);
+    m_kingInitialCol[color] = kingCol;
+    m_rookInitialCols[color][LONG_CASTLE] = longRookCol;
+    m_rookInitialCols[color][SHORT_CASTLE] = shortRookCol;
+    setCastlingRight(color, LONG_CASTLE, longRookCol != -1);
+    setCastlingRight(color, SHORT_CASTLE, shortRookCol != -1);
+}
+
+Bitboard Position::attacksFrom(Piece piece, int square, Bitboard occupied) {
+    switch (piece.type) {
+    case PAWN:   return pawnAttacks(piece.color, square);
+    case KNIGHT: return knightAttacks(square);
+    case BISHOP: return bishopAttacks(square, occupied);
+    case ROOK:   return rookAttacks(square, occupied);
+    case QUEEN:  return queenAttacks(square, occupied);
+    case KING:   return kingAttacks(square);
+    default:     return 0;
+    }
+}
+
+// Атаки «в обратную сторону»: из клетки square фигурой каждого типа.
+// Пешечные атаки берутся от противоположного цвета.
+Bitboard Position::attackersTo(int square, Bitboard occupied) const {
+    Bitboard diagonal = m_byType[BISHOP] | m_byType[QUEEN];
+    Bitboard straight = m_byType[ROOK] | m_byType[QUEEN];
+    return (pawnAttacks(BLACK, square) & pieces(WHITE, PAWN))
+         | (pawnAttacks(WHITE, square) & pieces(BLACK, PAWN))
+         | (knightAttacks(square) & m_byType[KNIGHT])
+         | (kingAttacks(square) & m_byType[KING])
+         | (bishopAttacks(square, occupied) & diagonal)
+         | (rookAttacks(square, occupied) & straight);
+}
+
+Bitboard Position::attacksBy(PieceColor color, Bitboard occupied) const {
+    Bitboard attacks = pawnAttacksBB(color, pieces(color, PAWN));
+    Bitboard knights = pieces(color, KNIGHT);
+    while (knights) attacks |= knightAttacks(popLsb(knights));
+    Bitboard diagonal = m_byColor[color] & (m_byType[BISHOP] | m_byType[QUEEN]);
+    while (diagonal) attacks |= bishopAttacks(popLsb(diagonal), occupied);
+    Bitboard straight = m_byColor[color] & (m_byType[ROOK] | m_byType[QUEEN]);
+    while (straight) attacks |= rookAttacks(popLsb(straight), occupied);
+    if (m_kingSquare[color] != -1) attacks |= kingAttacks(m_kingSquare[color]);
+    return attacks;
+}
+
+// Пересчет карт атак, шахов и связок для текущей расстановки.
+void Position::updateAttackInfo() {
+    Bitboard occ = occupied();
+    m_attackedBy[WHITE] = attacksBy(WHITE, occ);
+    m_attackedBy[BLACK] = attacksBy(BLACK, occ);
+    updateCheckInfo();
+}
+
+void Position::updateCheckInfo() {
+    Bitboard occ = occupied();
+    m_checkers = 0;
+    m_pinned = 0;
+
+    PieceColor us = m_sideToMove;
+    PieceColor them = oppositeColor(us);
+    int king = m_kingSquare[us];
+    if (king == -1) return;
+    m_checkers = attackersTo(king, occ) & m_byColor[them];
+
+    // Связка: между королем и дальнобойной фигурой соперника ровно одна наша фигура.
+    Bitboard snipers = (rookAttacks(king, 0) & m_byColor[them] & (m_byType[ROOK] | m_byType[QUEEN]))
+                     | (bishopAttacks(king, 0) & m_byColor[them] & (m_byType[BISHOP] | m_byType[QUEEN]));
+    while (snipers) {
+        Bitboard blockers = betweenBB(king, popLsb(snipers)) & occ;
+        if (blockers && !(blockers & (blockers - 1))) m_pinned |= blockers & m_byColor[us];
+    }
+}
+
+bool Position::isKingInCheck(PieceColor kingColor) const {
+    int king = m_kingSquare[kingColor];
+    return king != -1 && (m_attackedBy[oppositeColor(kingColor)] & squareBB(king));
+}
+
+bool Position::isLegal(PackedMove move) const {
+    PieceColor us = m_sideToMove;
+    PieceColor them = oppositeColor(us);
+    int from = moveFrom(move);
+    int to = moveTo(move);
+    int king = m_kingSquare[us];
+    Bitboard toBB = squareBB(to);
+
+    if (from == king) {
+        // Рокировку генератор выпускает уже полностью проверенной.
+        if (m_byColor[us] & toBB) return true;
+        if (m_attackedBy[them] & toBB) return false;
+        // Нельзя отступать вдоль линии шахующей дальнобойной фигуры.
+        Bitboard sliders = m_checkers & ~(m_byType[PAWN] | m_byType[KNIGHT] | m_byType[KING]);
+        while (sliders) {
+            int checker = popLsb(sliders);
+            if ((lineBB(checker, king) & toBB) && to != checker) return false;
+        }
+        return true;
+    }
+
+    // Взятие на проходе убирает с линии сразу две пешки — проверяем напрямую.
+    if (to == m_enPassantSquare && (m_byType[PAWN] & squareBB(from))) {
+        int capturedSquare = makeSquare(squareRow(from), squareCol(to));
+        Bitboard occ = (occupied() ^ squareBB(from) ^ squareBB(capturedSquare)) | toBB;
+        return !(attackersTo(king, occ) & m_byColor[them] & ~squareBB(capturedSquare));
+    }
+
+    if (m_checkers) {
+        if (m_checkers & (m_checkers - 1)) return false; // Двойной шах: ходит только король.
+        int checker = lsb(m_checkers);
+        if (!((betweenBB(king, checker) | m_checkers) & toBB)) return false;
+    }
+    return !(m_pinned & squareBB(from)) || (lineBB(king, from) & toBB);
+}
+
+bool Position::isInsufficientMaterial() const {
+    if (m_byType[PAWN] | m_byType[ROOK] | m_byType[QUEEN]) return false;
+    Bitboard minors = m_byType[KNIGHT] | m_byType[BISHOP];
+    if (popCount(minors) <= 1) return true;
+    if (m_byType[KNIGHT]) return false;
+    return !(m_byType[BISHOP] & LightSquaresBB) || !(m_byType[BISHOP] & ~LightSquaresBB);
+}
+
+bool Position::isCastlingMove(PackedMove move) const {
+    Bitboard from = squareBB(moveFrom(move));
+    Bitboard to = squareBB(moveTo(move));
+    return (pieces(m_sideToMove, KING) & from) && (pieces(m_sideToMove, ROOK) & to);
+}
+
+void Position::makeMove(PackedMove move, UndoInfo& undo) {
+    PieceColor us = m_sideToMove;
+    PieceColor them = oppositeColor(us);
+    int from = moveFrom(move);
+    int to = moveTo(move);
+    int fromRow = squareRow(from), fromCol = squareCol(from);
+    int toRow = squareRow(to), toCol = squareCol(to);
+    Piece movingPiece = pieceAt(from);
+
+    undo.moved = movingPiece;
+    undo.captured = {NONE, NO_COLOR};
+    undo.capturedSquare = -1;
+    undo.castlingRights = m_castlingRights;
+    undo.enPassantSquare = m_enPassantSquare;
+    undo.halfmoveClock = m_halfmoveClock;
+    undo.key = m_key;
+    undo.isCastling = isCastlingMove(move);
+    undo.attackedBy[WHITE] = m_attackedBy[WHITE];
+    undo.attackedBy[BLACK] = m_attackedBy[BLACK];
+    undo.checkers = m_checkers;
+    undo.pinned = m_pinned;
+
+    // Очередь хода и поле взятия на проходе в хеше; права на рокировку сверяются в конце хода.
+    m_key ^= Zobrist::keys.blackToMove;
+    if (m_enPassantSquare != -1) m_key ^= Zobrist::keys.enPassant[squareCol(m_enPassantSquare)];
+    m_enPassantSquare = -1;
+    ++m_halfmoveClock;
+    if (us == BLACK) ++m_fullmoveNumber;
+
+    if (undo.isCastling) {
+        bool isShortCastle = toCol > fromCol;
+        Piece rook = {ROOK, us};
+        // Безопасное выполнение: сначала убираем фигуры, потом ставим.
+        removePiece(from, movingPiece);
+        removePiece(to, rook);
+        putPiece(makeSquare(fromRow, isShortCastle ? 6 : 2), movingPiece);
+        putPiece(makeSquare(fromRow, isShortCastle ? 5 : 3), rook);
+        m_castlingRights &= ~(castlingBit(us, LONG_CASTLE) | castlingBit(us, SHORT_CASTLE));
+        m_key ^= castlingKey(undo.castlingRights) ^ castlingKey(m_castlingRights);
+        m_sideToMove = them;
+        updateAttackInfo();
+        return;
+    }
+
+    // Взятие на проходе: пешка ушла по диагонали на пустую клетку.
+    int capturedSquare = to;
+    if (movingPiece.type == PAWN && fromCol != toCol && !(occupied() & squareBB(to))) {
+        capturedSquare = makeSquare(fromRow, toCol);
+    }
+    Piece captured = pieceAt(capturedSquare);
+    if (captured.type != NONE) {
+        removePiece(capturedSquare, captured);
+        undo.captured = captured;
+        undo.capturedSquare = capturedSquare;
+        m_halfmoveClock = 0;
+        // Взятая на исходной клетке ладья лишает соперника рокировки в ее сторону.
+        int theirHomeRow = (them == WHITE) ? 7 : 0;
+        if (captured.type == ROOK && toRow == theirHomeRow) {
+            if (toCol == m_rookInitialCols[them][LONG_CASTLE]) m_castlingRights &= ~castlingBit(them, LONG_CASTLE);
+            if (toCol == m_rookInitialCols[them][SHORT_CASTLE]) m_castlingRights &= ~castlingBit(them, SHORT_CASTLE);
+        }
+    }
+
+    removePiece(from, movingPiece);
+    Piece placed = movingPiece;
+    if (movingPiece.type == PAWN && movePromotion(move) != NONE && (toRow == 0 || toRow == 7)) {
+        placed.type = movePromotion(move);
+    }
+    putPiece(to, placed);
+
+    // Обновление прав на рокировку.
+    int ourHomeRow = (us == WHITE) ? 7 : 0;
+    if (movingPiece.type == KING) {
+        m_castlingRights &= ~(castlingBit(us, LONG_CASTLE) | castlingBit(us, SHORT_CASTLE));
+    } else if (movingPiece.type == ROOK && fromRow == ourHomeRow) {
+        if (fromCol == m_rookInitialCols[us][LONG_CASTLE]) m_castlingRights &= ~castlingBit(us, LONG_CASTLE);
+        if (fromCol == m_rookInitialCols[us][SHORT_CASTLE]) m_castlingRights &= ~castlingBit(us, SHORT_CASTLE);
+    }
+    if (m_castlingRights != undo.castlingRights) {
+        m_key ^= castlingKey(undo.castlingRights) ^ castlingKey(m_castlingRights);
+    }
+
+    if (movingPiece.type == PAWN) {
+        m_halfmoveClock = 0;
+        // Поле взятия на проходе — только если рядом стоит пешка соперника.
+        if (fromRow - toRow == 2 || toRow - fromRow == 2) {
+            int square = (from + to) / 2;
+            if (pawnAttacks(us, square) & pieces(them, PAWN)) {
+                m_enPassantSquare = square;
+                m_key ^= Zobrist::keys.enPassant[fromCol];
+            }
+        }
+    }
+    m_sideToMove = them;
+    updateAttackInfo();
+}
+
+void Position::unmakeMove(PackedMove move, const UndoInfo& undo) {
+    PieceColor us = oppositeColor(m_sideToMove);
+    int from = moveFrom(move);
+    int to = moveTo(move);
+
+    m_sideToMove = us;
+    m_castlingRights = undo.castlingRights;
+    m_enPassantSquare = undo.enPassantSquare;
+    m_halfmoveClock = undo.halfmoveClock;
+    if (us == BLACK) --m_fullmoveNumber;
+    m_attackedBy[WHITE] = undo.attackedBy[WHITE];
+    m_attackedBy[BLACK] = undo.attackedBy[BLACK];
+    m_checkers = undo.checkers;
+    m_pinned = undo.pinned;
+
+    if (undo.isCastling) {
+        bool isShortCastle = squareCol(to) > squareCol(from);
+        Piece king = {KING, us};
+        Piece rook = {ROOK, us};
+        int row = squareRow(from);
+        removePiece(makeSquare(row, isShortCastle ? 6 : 2), king);
+        removePiece(makeSquare(row, isShortCastle ? 5 : 3), rook);
+        putPiece(from, king);
+        putPiece(to, rook);
+    } else {
+        removePiece(to, pieceAt(to));
+        putPiece(from, undo.moved);
+        if (undo.captured.type != NONE) putPiece(undo.capturedSquare, undo.captured);
+    }
+    m_key = undo.key;
+}
+
+void Position::makeNullMove(UndoInfo& undo) {
+    undo.enPassantSquare = m_enPassantSquare;
+    undo.halfmoveClock = m_halfmoveClock;
+    undo.key = m_key;
+    undo.attackedBy[WHITE] = m_attackedBy[WHITE];
+    undo.attackedBy[BLACK] = m_attackedBy[BLACK];
+    undo.checkers = m_checkers;
+    undo.pinned = m_pinned;
+
+    m_key ^= Zobrist::keys.blackToMove;
+    if (m_enPassantSquare != -1) m_key ^= Zobrist::keys.enPassant[squareCol(m_enPassantSquare)];
+    m_enPassantSquare = -1;
+    ++m_halfmoveClock;
+    m_sideToMove = oppositeColor(m_sideToMove);
+    // Карты атак не меняются, пересчитываются только шахи и связки новой стороны.
+    updateCheckInfo();
+}
+
+void Position::unmakeNullMove(const UndoInfo& undo) {
+    m_sideToMove = oppositeColor(m_sideToMove);
+    m_enPassantSquare = undo.enPassantSquare;
+    m_halfmoveClock = undo.halfmoveClock;
+    m_key = undo.key;
+    m_attackedBy[WHITE] = undo.attackedBy[WHITE];
+    m_attackedBy[BLACK] = undo.attackedBy[BLACK];
+    m_checkers = undo.checkers;
+    m_pinned = undo.pinned;
+}
+
+MoveDelta::MoveDelta(PackedMove move, const UndoInfo& undo)
+    : move(move), moved(packPiece(undo.moved)), captured(packPiece(undo.captured)),
+      capturedSquare(static_cast<int8_t>(undo.capturedSquare)), enPassantSquare(static_cast<int8_t>(undo.enPassantSquare)),
+      castlingRights(static_cast<uint8_t>(undo.castlingRights)), isCastling(undo.isCastling),
+      halfmoveClock(static_cast<uint16_t>(undo.halfmoveClock)) {}
+
+void Position::unmakeMove(const MoveDelta& delta, uint64_t previousKey) {
+    UndoInfo undo;
+    undo.moved = unpackPiece(delta.moved);
+    undo.captured = unpackPiece(delta.captured);
+    undo.capturedSquare = delta.capturedSquare;
+    undo.castlingRights = delta.castlingRights;
+    undo.enPassantSquare = delta.enPassantSquare;
+    undo.halfmoveClock = delta.halfmoveClock;
+    undo.key = previousKey;
+    undo.isCastling = delta.isCastling;
+    unmakeMove(delta.move, undo);
+    updateAttackInfo();
+}
+
+namespace {
+const char PieceChars[] = " kqrbnp";
+}
+
+bool Position::setFromFen(const std::string& fen) {
+    clear();
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    int halfmoveClock = 0, fullmoveNumber = 1;
+    stream >> placement >> side >> castling >> enPassant >> halfmoveClock >> fullmoveNumber; // Счетчики ходов необязательны.
+
+    int row = 0, col = 0;
+    for (char ch : placement) {
+        if (ch == '/') {
+            if (col != 8) return false;
+            ++row;
+            col = 0;
+        } else if (ch >= '1' && ch <= '8') {
+            col += ch - '0';
+        } else {
+            const char* found = std::strchr(PieceChars + 1, std::tolower(static_cast<unsigned char>(ch)));
+            if (!found || row > 7 || col > 7) return false;
+            PieceColor color = std::isupper(static_cast<unsigned char>(ch)) ? WHITE : BLACK;
+            putPiece(makeSquare(row, col), {static_cast<PieceType>(found - PieceChars), color});
+            ++col;
+        }
+    }
+    if (row != 7 || col != 8) return false;
+    if (kingSquare(WHITE) == -1 || kingSquare(BLACK) == -1) return false;
+
+    if (side == "w") setSideToMove(WHITE);
+    else if (side == "b") setSideToMove(BLACK);
+    else return false;
+    if (halfmoveClock < 0) return false;
+    m_halfmoveClock = halfmoveClock;
+    m_fullmoveNumber = std::max(fullmoveNumber, 1);
+
+    // Рокировка: KQkq — крайняя ладья со своей стороны, буквы A-H — вертикаль ладьи.
+    int rookCols[3][2] = { {-1, -1}, {-1, -1}, {-1, -1} };
+    if (castling != "-") {
+        for (char ch : castling) {
+            PieceColor color = std::isupper(static_cast<unsigned char>(ch)) ? WHITE : BLACK;
+            int homeRow = (color == WHITE) ? 7 : 0;
+            int king = kingSquare(color);
+            if (squareRow(king) != homeRow) return false;
+            int kingCol = squareCol(king);
+            char lower = static_cast<char>(std::tolower(ch));
+            int rookCol = -1;
+            if (lower == 'k') {
+                for (int c = 7; c > kingCol && rookCol == -1; --c) if (pieces(color, ROOK) & squareBB(makeSquare(homeRow, c))) rookCol = c;
+            } else if (lower == 'q') {
+                for (int c = 0; c < kingCol && rookCol == -1; ++c) if (pieces(color, ROOK) & squareBB(makeSquare(homeRow, c))) rookCol = c;
+            } else if (lower >= 'a' && lower <= 'h') {
+                rookCol = lower - 'a';
+            } else {
+                return false;
+            }
+            if (rookCol == -1 || rookCol == kingCol || !(pieces(color, ROOK) & squareBB(makeSquare(homeRow, rookCol)))) return false;
+            rookCols[color][rookCol > kingCol ? SHORT_CASTLE : LONG_CASTLE] = rookCol;
+        }
+    }
+    for (PieceColor color : {WHITE, BLACK}) {
+        setCastlingFiles(color, squareCol(kingSquare(color)), rookCols[color][LONG_CASTLE], rookCols[color][SHORT_CASTLE]);
+    }
+
+    if (enPassant != "-" && !enPassant.empty()) {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] < '1' || enPassant[1] > '8') return false;
+        int square = makeSquare('8' - enPassant[1], enPassant[0] - 'a');
+        if (pawnAttacks(oppositeColor(m_sideToMove), square) & pieces(m_sideToMove, PAWN)) setEnPassantSquare(square);
+    }
+    updateAttackInfo();
+    return true;
+}
+
+std::string Position::fen() const {
+    std::string result;
+    for (int row = 0; row < 8; ++row) {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col) {
+            Piece piece = pieceAt(makeSquare(row, col));
+            if (piece.type == NONE) { ++empty; continue; }
+            if (empty) { result += static_cast<char>('0' + empty); empty = 0; }
+            char ch = PieceChars[piece.type];
+            result += (piece.color == WHITE) ? static_cast<char>(std::toupper(ch)) : ch;
+        }
+        if (empty) result += static_cast<char>('0' + empty);
+        if (row < 7) result += '/';
+    }
+    result += (m_sideToMove == WHITE) ? " w " : " b ";
+
+    std::string castling;
+    for (PieceColor color : {WHITE, BLACK}) {
+        for (int side : {SHORT_CASTLE, LONG_CASTLE}) {
+            if (!canCastle(color, side)) continue;
+            char file = static_cast<char>('a' + m_rookInitialCols[color][side]);
+            castling += (color == WHITE) ? static_cast<char>(std::toupper(file)) : file;
+        }
+    }
+    result += castling.empty() ? "-" : castling;
+    result += ' ';
+    if (m_enPassantSquare == -1) {
+        result += '-';
+    } else {
+        result += static_cast<char>('a' + squareCol(m_enPassantSquare));
+        result += static_cast<char>('8' - squareRow(m_enPassantSquare));
+    }
+    result += ' ' + std::to_string(m_halfmoveClock) + ' ' + std::to_string(m_fullmoveNumber);
+    return result;
+}
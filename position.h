@@ -0,0 +1,176 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include "chess_types.h"
+#include "bitboard.h"
+#include "psqt.h"
+#include <string>
+
+// Индексы сторон рокировки.
+enum CastlingSide { LONG_CASTLE = 0, SHORT_CASTLE = 1 };
+
+// Все, что нужно для отмены хода: makeMove заполняет, unmakeMove читает.
+struct UndoInfo {
+    Piece moved;             // Фигура, сделавшая ход (пешка при превращении).
+    Piece captured;          // Взятая фигура (NONE, если взятия не было).
+    int capturedSquare = -1; // Клетка взятой фигуры (отличается от toSquare при взятии на проходе).
+    int castlingRights = 0;  // Права на рокировку до хода.
+    int enPassantSquare = -1; // Поле взятия на проходе до хода.
+    int halfmoveClock = 0;   // Счетчик правила 50 ходов до хода.
+    uint64_t key = 0;        // Хеш Зобриста до хода.
+    bool isCastling = false;
+    // Карты атак до хода (восстанавливаются без пересчета).
+    Bitboard attackedBy[3] = {0, 0, 0};
+    Bitboard checkers = 0;
+    Bitboard pinned = 0;
+};
+
+// Сжатая запись хода для истории партии (10 байт): данные UndoInfo без карт атак
+// и хеша — их восстанавливает Position::unmakeMove(MoveDelta, ...).
+struct MoveDelta {
+    PackedMove move = NullMove;
+    PackedPiece moved = 0;
+    PackedPiece captured = 0;
+    int8_t capturedSquare = -1;
+    int8_t enPassantSquare = -1;
+    uint8_t castlingRights = 0;
+    bool isCastling = false;
+    uint16_t halfmoveClock = 0;
+
+    MoveDelta() = default;
+    MoveDelta(PackedMove move, const UndoInfo& undo);
+};
+
+/**
+ * @class Position
+ * @brief Позиция в виде битбордов: расстановка, очередь хода, права на рокировку.
+ *
+ * Хранит по одному 64-битному множеству на каждый тип фигуры и на каждый цвет,
+ * а также доску из 64 упакованных фигур (одна кеш-линия) для ответа «что на клетке».
+ * Занятость доски и атаки вычисляются операциями над множествами,
+ * без перебора клеток. Ходы выполняются и отменяются на месте
+ * (makeMove/unmakeMove), без копирования доски. Не зависит от Qt.
+ *
+ * Вместе с расстановкой поддерживаются клетки королей и карты атак:
+ * поля под боем каждой стороны, шахующие фигуры и связанные фигуры стороны,
+ * которой ходить. makeMove пересчитывает их один раз за ход, unmakeMove
+ * восстанавливает из UndoInfo, поэтому шах, связка и проверка пути рокировки —
+ * это просмотр готовых битбордов. После ручной расстановки через putPiece/removePiece
+ * нужно вызвать updateAttackInfo().
+ *
+ * Хеш Зобриста (key()) обновляется инкрементально при любом изменении позиции —
+ * и в makeMove, и в сеттерах ручной расстановки. Поле взятия на проходе
+ * запоминается, только если пешка соперника действительно может на него побить,
+ * иначе одинаковые позиции получали бы разные хеши.
+ *
+ * Так же, в putPiece/removePiece, поддерживаются материал с позиционными бонусами
+ * (psqScore, см. psqt.h) и стадия партии (gamePhase): оценке не нужно обходить доску.
+ */
+class Position
+{
+public:
+    Position();
+
+    void clear();
+    void putPiece(int square, Piece piece);    // Клетка должна быть пустой.
+    void removePiece(int square, Piece piece); // piece должна стоять на square.
+    Piece pieceAt(int square) const { return unpackPiece(m_board[square]); }
+    const PackedPiece* board() const { return m_board; } // 64 упакованные фигуры, клетка = row * 8 + col.
+
+    Bitboard pieces(PieceColor color) const { return m_byColor[color]; }
+    Bitboard pieces(PieceColor color, PieceType type) const { return m_byColor[color] & m_byType[type]; }
+    Bitboard pieces(PieceType type) const { return m_byType[type]; }
+    Bitboard occupied() const { return m_byColor[WHITE] | m_byColor[BLACK]; }
+
+    // --- Состояние партии ---
+    PieceColor sideToMove() const { return m_sideToMove; }
+    void setSideToMove(PieceColor color);
+    int enPassantSquare() const { return m_enPassantSquare; }
+    void setEnPassantSquare(int square);
+    // Полуходы без взятий и ходов пешкой (правило 50 ходов) и номер хода из FEN.
+    int halfmoveClock() const { return m_halfmoveClock; }
+    int fullmoveNumber() const { return m_fullmoveNumber; }
+    uint64_t key() const { return m_key; }
+    // Материал и бонусы клеток с точки зрения белых; стадия партии (0..24 и выше при превращениях).
+    EvalScore psqScore() const { return m_psq; }
+    int gamePhase() const { return m_phase; }
+
+    // Ни одна сторона не может поставить мат: короли с одной легкой фигурой
+    // или только слоны на полях одного цвета.
+    bool isInsufficientMaterial() const;
+
+    // Права на рокировку хранятся битовой маской: по биту на цвет и сторону.
+    static int castlingBit(PieceColor color, int side) { return 1 << ((color - 1) * 2 + side); }
+    int castlingRights() const { return m_castlingRights; }
+    bool canCastle(PieceColor color, int side) const { return (m_castlingRights & castlingBit(color, side)) != 0; }
+    void setCastlingRight(PieceColor color, int side, bool allowed);
+    // Исходные вертикали короля и ладей (Chess960); выдает обоим цветам полные права.
+    void setCastlingFiles(int kingCol, int longRookCol, int shortRookCol);
+    void setCastlingFiles(PieceColor color, int kingCol, int longRookCol, int shortRookCol);
+    int kingInitialCol(PieceColor color) const { return m_kingInitialCol[color]; }
+    int rookInitialCol(PieceColor color, int side) const { return m_rookInitialCols[color][side]; }
+
+    // Клетка короля цвета color или -1, если короля нет на доске.
+    int kingSquare(PieceColor color) const { return m_kingSquare[color]; }
+
+    // Все фигуры обоих цветов, атакующие клетку square при занятости occupied.
+    Bitboard attackersTo(int square, Bitboard occupied) const;
+    // Поля, которые бьют фигуры цвета color при занятости occupied.
+    Bitboard attacksBy(PieceColor color, Bitboard occupied) const;
+
+    // --- Поддерживаемые карты атак ---
+    void updateAttackInfo();
+    Bitboard attackedBy(PieceColor color) const { return m_attackedBy[color]; }
+    Bitboard checkers() const { return m_checkers; }     // Фигуры, объявившие шах стороне, которой ходить.
+    Bitboard pinnedPieces() const { return m_pinned; }   // Связанные фигуры стороны, которой ходить.
+    bool isSquareAttacked(int square, PieceColor attackerColor) const { return (m_attackedBy[attackerColor] & squareBB(square)) != 0; }
+    bool isKingInCheck(PieceColor kingColor) const;
+
+    // Поля, которые бьет фигура piece с клетки square (для пешки — только взятия).
+    static Bitboard attacksFrom(Piece piece, int square, Bitboard occupied);
+
+    // Рокировка кодируется ходом короля на клетку своей ладьи.
+    bool isCastlingMove(PackedMove move) const;
+
+    // FEN с рокировкой в нотации Shredder-FEN (вертикали ладей, напр. "HAha");
+    // при чтении принимаются также KQkq. Возвращает false для некорректной строки.
+    bool setFromFen(const std::string& fen);
+    std::string fen() const;
+
+    // Легален ли псевдолегальный ход (из generatePseudoLegalMoves) — без выполнения хода.
+    bool isLegal(PackedMove move) const;
+
+    // Выполняет псевдолегальный ход на месте и запоминает данные для отмены.
+    void makeMove(PackedMove move, UndoInfo& undo);
+    void unmakeMove(PackedMove move, const UndoInfo& undo);
+    // Пропуск хода (для отсечения нулевым ходом в поиске). Нельзя делать под шахом.
+    void makeNullMove(UndoInfo& undo);
+    void unmakeNullMove(const UndoInfo& undo);
+    // Отмена по сжатой записи: previousKey — хеш позиции до хода, карты атак пересчитываются.
+    void unmakeMove(const MoveDelta& delta, uint64_t previousKey);
+
+private:
+    uint64_t castlingKey(int rights) const;
+    void updateCheckInfo(); // Шахи и связки стороны, которой ходить.
+
+    Bitboard m_byType[7];  // Индекс — PieceType (NONE не используется).
+    Bitboard m_byColor[3]; // Индекс — PieceColor (NO_COLOR не используется).
+    PackedPiece m_board[64]; // Фигура на каждой клетке — для быстрого pieceAt.
+    PieceColor m_sideToMove;
+    int m_castlingRights;
+    int m_enPassantSquare;
+    int m_kingInitialCol[3];
+    int m_rookInitialCols[3][2];
+    int m_halfmoveClock;
+    int m_fullmoveNumber;
+    uint64_t m_key;
+    EvalScore m_psq;
+    int m_phase;
+
+    int m_kingSquare[3];
+    Bitboard m_attackedBy[3];
+    Bitboard m_checkers;
+    Bitboard m_pinned;
+};
+
+#endif // POSITION_H
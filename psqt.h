@@ -0,0 +1,160 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include "chess_types.h"
+
+// Оценка из двух частей — для миттельшпиля (mg) и эндшпиля (eg); итог смешивается
+// по стадии партии. В сотых пешки.
+struct EvalScore {
+    int mg = 0;
+    int eg = 0;
+
+    constexpr EvalScore() = default;
+    constexpr EvalScore(int mg, int eg) : mg(mg), eg(eg) {}
+
+    constexpr EvalScore operator+(EvalScore other) const { return EvalScore(mg + other.mg, eg + other.eg); }
+    constexpr EvalScore operator-(EvalScore other) const { return EvalScore(mg - other.mg, eg - other.eg); }
+    constexpr EvalScore operator-() const { return EvalScore(-mg, -eg); }
+    constexpr EvalScore operator*(int factor) const { return EvalScore(mg * factor, eg * factor); }
+    EvalScore& operator+=(EvalScore other) { mg += other.mg; eg += other.eg; return *this; }
+    EvalScore& operator-=(EvalScore other) { mg -= other.mg; eg -= other.eg; return *this; }
+    constexpr bool operator==(EvalScore other) const { return mg == other.mg && eg == other.eg; }
+    constexpr bool operator!=(EvalScore other) const { return !(*this == other); }
+};
+
+/*
+ * Материал и позиционные таблицы фигур (PST). Для каждой фигуры на каждой клетке
+ * хранится готовый вклад с точки зрения белых (материал + бонус клетки, у черных
+ * со знаком минус), поэтому Position поддерживает сумму инкрементально —
+ * одним сложением в putPiece/removePiece, как и хеш Зобриста.
+ */
+namespace Psqt {
+
+// Вклад фигур в стадию партии: 24 — все фигуры на доске (миттельшпиль), 0 — только пешки.
+constexpr int PiecePhase[7] = { 0, 0, 4, 2, 1, 1, 0 };
+constexpr int MaxPhase = 24;
+
+constexpr EvalScore Material[7] = {
+    {}, {}, { 900, 950 }, { 480, 520 }, { 330, 300 }, { 320, 280 }, { 90, 120 }
+};
+
+// Таблицы для белых записаны «как доска»: первая строка — 8-я горизонталь (row 0).
+// Для черных клетка отражается по вертикали (square ^ 56).
+constexpr int MidgameTables[7][64] = {
+    {},
+    { // Король: укрытие за пешками, подальше от центра.
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -30,-40,-40,-50,-50,-40,-40,-30,
+        -20,-30,-30,-40,-40,-30,-30,-20,
+        -10,-20,-20,-20,-20,-20,-20,-10,
+         20, 20,  0,  0,  0,  0, 20, 20,
+         20, 30, 10,  0,  0, 10, 30, 20
+    },
+    { // Ферзь.
+        -20,-10,-10, -5, -5,-10,-10,-20,
+        -10,  0,  0,  0,  0,  0,  0,-10,
+        -10,  0,  5,  5,  5,  5,  0,-10,
+         -5,  0,  5,  5,  5,  5,  0, -5,
+          0,  0,  5,  5,  5,  5,  0, -5,
+        -10,  5,  5,  5,  5,  5,  0,-10,
+        -10,  0,  5,  0,  0,  0,  0,-10,
+        -20,-10,-10, -5, -5,-10,-10,-20
+    },
+    { // Ладья: седьмая горизонталь и центральные вертикали.
+          0,  0,  0,  0,  0,  0,  0,  0,
+          5, 10, 10, 10, 10, 10, 10,  5,
+         -5,  0,  0,  0,  0,  0,  0, -5,
+         -5,  0,  0,  0,  0,  0,  0, -5,
+         -5,  0,  0,  0,  0,  0,  0, -5,
+         -5,  0,  0,  0,  0,  0,  0, -5,
+         -5,  0,  0,  0,  0,  0,  0, -5,
+          0,  0,  0,  5,  5,  0,  0,  0
+    },
+    { // Слон.
+        -20,-10,-10,-10,-10,-10,-10,-20,
+        -10,  0,  0,  0,  0,  0,  0,-10,
+        -10,  0,  5, 10, 10,  5,  0,-10,
+        -10,  5,  5, 10, 10,  5,  5,-10,
+        -10,  0, 10, 10, 10, 10,  0,-10,
+        -10, 10, 10, 10, 10, 10, 10,-10,
+        -10,  5,  0,  0,  0,  0,  5,-10,
+        -20,-10,-10,-10,-10,-10,-10,-20
+    },
+    { // Конь: центр, а не край доски.
+        -50,-40,-30,-30,-30,-30,-40,-50,
+        -40,-20,  0,  0,  0,  0,-20,-40,
+        -30,  0, 10, 15, 15, 10,  0,-30,
+        -30,  5, 15, 20, 20, 15,  5,-30,
+        -30,  0, 15, 20, 20, 15,  0,-30,
+        -30,  5, 10, 15, 15, 10,  5,-30,
+        -40,-20,  0,  5,  5,  0,-20,-40,
+        -50,-40,-30,-30,-30,-30,-40,-50
+    },
+    { // Пешка: продвижение и центр.
+          0,  0,  0,  0,  0,  0,  0,  0,
+         50, 50, 50, 50, 50, 50, 50, 50,
+         10, 10, 20, 30, 30, 20, 10, 10,
+          5,  5, 10, 25, 25, 10,  5,  5,
+          0,  0,  0, 20, 20,  0,  0,  0,
+          5, -5,-10,  0,  0,-10, -5,  5,
+          5, 10, 10,-20,-20, 10, 10,  5,
+          0,  0,  0,  0,  0,  0,  0,  0
+    },
+};
+
+// В эндшпиле меняются король (идет в центр) и пешки (ценится только продвижение);
+// для остальных фигур используются таблицы миттельшпиля.
+constexpr int KingEndgameTable[64] = {
+    -50,-40,-30,-20,-20,-30,-40,-50,
+    -30,-20,-10,  0,  0,-10,-20,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 30, 40, 40, 30,-10,-30,
+    -30,-10, 20, 30, 30, 20,-10,-30,
+    -30,-30,  0,  0,  0,  0,-30,-30,
+    -50,-30,-30,-30,-30,-30,-30,-50
+};
+
+constexpr int PawnEndgameTable[64] = {
+      0,  0,  0,  0,  0,  0,  0,  0,
+     80, 80, 80, 80, 80, 80, 80, 80,
+     50, 50, 50, 50, 50, 50, 50, 50,
+     30, 30, 30, 30, 30, 30, 30, 30,
+     15, 15, 15, 15, 15, 15, 15, 15,
+      5,  5,  5,  5,  5,  5,  5,  5,
+      0,  0,  0,  0,  0,  0,  0,  0,
+      0,  0,  0,  0,  0,  0,  0,  0
+};
+
+// Бонус клетки для белой фигуры (без материала).
+constexpr EvalScore pieceSquareBonus(int type, int square) {
+    int eg = (type == KING) ? KingEndgameTable[square]
+           : (type == PAWN) ? PawnEndgameTable[square]
+           : MidgameTables[type][square];
+    return EvalScore(MidgameTables[type][square], eg);
+}
+
+struct Table {
+    EvalScore values[3][7][64];   // [цвет][тип][клетка], с точки зрения белых.
+};
+
+constexpr Table makeTable() {
+    Table table{};
+    for (int type = KING; type <= PAWN; ++type) {
+        for (int square = 0; square < 64; ++square) {
+            table.values[WHITE][type][square] = Material[type] + pieceSquareBonus(type, square);
+            table.values[BLACK][type][square] = -(Material[type] + pieceSquareBonus(type, square ^ 56));
+        }
+    }
+    return table;
+}
+
+inline constexpr Table table = makeTable();
+
+inline EvalScore value(Piece piece, int square) { return table.values[piece.color][piece.type][square]; }
+
+} // namespace Psqt
+
+#endif // PSQT_H
@@ -0,0 +1,508 @@
+#include "search.h"
+#include "evaluate.h"
+#include "nnue.h"
+#include "tablebase.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+namespace {
+
+const int Infinity = MateScore + 1;
+const int CheckLimitsInterval = 2048;     // Как часто (в узлах) проверять время и лимит узлов.
+
+// Приоритеты сортировки ходов.
+const int HashMoveScore = 1 << 30;
+const int CaptureScore = 1 << 28;         // + MVV-LVA
+const int PromotionScore = 1 << 27;
+const int FirstKillerScore = 1 << 26;
+const int SecondKillerScore = FirstKillerScore - 1;
+const int HistoryLimit = 1 << 20;         // Ниже killer-ходов при любых значениях истории.
+
+// Переставляет на место index ход с наибольшей оценкой: сортировка выбором
+// по одному ходу за раз, так как после отсечения остальные ходы не нужны.
+void pickNextMove(MoveList& moves, int scores[], int index) {
+    int best = index;
+    for (int i = index + 1; i < moves.size; ++i) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    std::swap(moves.moves[index], moves.moves[best]);
+    std::swap(scores[index], scores[best]);
+}
+
+// Мат (и выигрыш по таблицам эндшпиля) хранится в таблице относительно узла, а не корня:
+// так запись верна на любой глубине, где встретится та же позиция.
+int scoreToTT(int score, int ply) {
+    if (score > TbWinScore - MaxPly) return score + ply;
+    if (score < -TbWinScore + MaxPly) return score - ply;
+    return score;
+}
+
+int scoreFromTT(int score, int ply) {
+    if (score > TbWinScore - MaxPly) return score - ply;
+    if (score < -TbWinScore + MaxPly) return score + ply;
+    return score;
+}
+
+bool hasNonPawnMaterial(const Position& position, PieceColor color) {
+    return (position.pieces(color) & ~position.pieces(color, PAWN) & ~position.pieces(color, KING)) != 0;
+}
+
+} // namespace
+
+SearchWorker::SearchWorker(int id, Search& owner)
+    : m_id(id), m_owner(owner), m_tt(owner.m_tt), m_stop(owner.m_stop),
+      m_rootDepth(0), m_useNnue(false) {
+    std::memset(m_killers, 0, sizeof(m_killers));
+    std::memset(m_history, 0, sizeof(m_history));
+    std::memset(m_pvLength, 0, sizeof(m_pvLength));
+}
+
+void SearchWorker::prepare(const Position& root, const std::vector<uint64_t>& keys, const SearchLimits& limits) {
+    m_position = root;
+    m_keys = keys;
+    m_limits = limits;
+    m_result = SearchResult();
+    m_counters = SearchCounters();
+    m_published.publish(m_counters);
+    m_iterationSeconds.clear();
+    m_rootDepth = 0;
+    m_useNnue = Nnue::isLoaded();
+    if (m_useNnue) Nnue::refreshAccumulator(m_position, m_accumulators[0]);
+    std::memset(m_killers, 0, sizeof(m_killers));
+    std::memset(m_history, 0, sizeof(m_history));
+}
+
+void SearchWorker::iterate() {
+    int maxDepth = m_limits.depth > 0 ? std::min(m_limits.depth, MaxSearchDepth) : MaxSearchDepth;
+    // Нечетные вспомогательные потоки начинают на полуход глубже.
+    int firstDepth = (m_id % 2 == 1) ? 2 : 1;
+    double iterationStartMs = 0;
+    for (int depth = firstDepth; depth <= maxDepth; ++depth) {
+        m_rootDepth = depth;
+        int score = negamax(depth, -Infinity, Infinity, 0, false);
+        if (m_stop && depth > 1) break;  // Незавершенная итерация отбрасывается.
+
+        m_result.depth = depth;
+        m_result.score = score;
+        m_result.pv.assign(m_pv[0], m_pv[0] + m_pvLength[0]);
+        if (!m_result.pv.empty()) m_result.bestMove = m_result.pv.front();
+
+        if (m_id != 0) {
+            if (m_stop) break;
+            continue;
+        }
+        double nowMs = m_owner.elapsedMs();
+        m_iterationSeconds.push_back((nowMs - iterationStartMs) / 1000);
+        iterationStartMs = nowMs;
+        m_published.publish(m_counters);
+        if (m_limits.multiPv > 1) searchOtherLines(depth);
+        m_owner.reportProgress(m_result);
+        // Пока идет обдумывание, ни мат, ни время не останавливают поиск.
+        if (m_owner.m_pondering) {
+            if (m_stop) break;
+            continue;
+        }
+        // Найденный мат глубже не улучшится.
+        if (isMateScore(score) && MateScore - std::abs(score) <= depth) break;
+        // Следующая итерация дольше всех предыдущих вместе: не начинаем ее без шансов закончить.
+        if (m_limits.moveTimeMs > 0 && m_owner.elapsedMs() * 2 > m_limits.moveTimeMs) break;
+        if (m_stop) break;
+    }
+    // Обдумывание дошло до предельной глубины: ход отдается только после ponderHit или stop.
+    while (m_id == 0 && m_owner.m_pondering && !m_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    m_published.publish(m_counters);
+}
+
+// Корень ищется заново без ходов уже найденных вариантов; вспомогательные потоки
+// помогают только через таблицу. Если поиск остановили посреди итерации, недостающие
+// варианты берутся из предыдущей.
+void SearchWorker::searchOtherLines(int depth) {
+    std::vector<SearchLine> lines(1);
+    lines[0].score = m_result.score;
+    lines[0].pv = m_result.pv;
+    for (int k = 1; k < m_limits.multiPv && !lines.back().pv.empty(); ++k) {
+        m_excludedRootMoves.push_back(lines.back().pv.front());
+        int score = negamax(depth, -Infinity, Infinity, 0, false);
+        if (m_stop || m_pvLength[0] == 0) break;
+        lines.push_back(SearchLine{ score, std::vector<PackedMove>(m_pv[0], m_pv[0] + m_pvLength[0]) });
+    }
+    m_excludedRootMoves.clear();
+    std::stable_sort(lines.begin() + 1, lines.end(),
+                     [](const SearchLine& a, const SearchLine& b) { return a.score > b.score; });
+
+    for (const SearchLine& previous : m_result.lines) {
+        if (static_cast<int>(lines.size()) >= m_limits.multiPv) break;
+        bool found = false;
+        for (const SearchLine& line : lines) found = found || line.pv.front() == previous.pv.front();
+        if (!found) lines.push_back(previous);
+    }
+    m_result.lines = std::move(lines);
+}
+
+bool SearchWorker::isExcludedRootMove(PackedMove move) const {
+    return std::find(m_excludedRootMoves.begin(), m_excludedRootMoves.end(), move) != m_excludedRootMoves.end();
+}
+
+void SearchWorker::checkLimits() {
+    m_published.publish(m_counters);
+    // Лимиты проверяет только главный поток; первая итерация всегда завершается, чтобы был ход.
+    if (m_id != 0 || m_rootDepth <= 1 || m_owner.m_pondering) return;
+    if (m_limits.nodes > 0 && m_owner.nodesSearched() >= m_limits.nodes) m_stop = true;
+    if (m_limits.moveTimeMs > 0 && m_owner.elapsedMs() >= m_limits.moveTimeMs) m_stop = true;
+}
+
+Search::Search() : m_stop(false), m_pondering(false), m_armed(false), m_startTicks(0) {
+    setThreads(1);
+}
+
+void Search::arm(const SearchLimits& limits) {
+    m_stop = false;
+    m_pondering = limits.ponder;
+    m_startTicks = std::chrono::steady_clock::now().time_since_epoch().count();
+    m_armed = true;
+}
+
+void Search::ponderHit() {
+    m_startTicks = std::chrono::steady_clock::now().time_since_epoch().count();
+    m_pondering = false;
+}
+
+double Search::elapsedMs() const {
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now().time_since_epoch()
+                                                  - std::chrono::steady_clock::duration(m_startTicks.load());
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+void Search::reportProgress(const SearchResult& iteration) const {
+    if (!m_progress) return;
+    SearchResult progress = iteration;
+    progress.stats = stats();
+    progress.stats.depth = iteration.depth;
+    progress.stats.iterationSeconds = m_workers[0]->iterationSeconds();
+    progress.nodes = progress.stats.totals.nodes;
+    progress.seconds = progress.stats.seconds;
+    m_progress(progress);
+}
+
+Search::~Search() = default;
+
+void Search::setThreads(int count) {
+    count = std::max(1, std::min(count, MaxThreads));
+    m_workers.resize(std::min<size_t>(m_workers.size(), count));
+    while (static_cast<int>(m_workers.size()) < count) {
+        m_workers.emplace_back(new SearchWorker(static_cast<int>(m_workers.size()), *this));
+    }
+}
+
+uint64_t Search::nodesSearched() const {
+    uint64_t nodes = 0;
+    for (const auto& worker : m_workers) nodes += worker->publishedNodes();
+    return nodes;
+}
+
+SearchStats Search::stats() const {
+    SearchStats stats;
+    for (const auto& worker : m_workers) stats.totals.add(worker->publishedCounters());
+    stats.threads = threads();
+    stats.seconds = elapsedMs() / 1000;
+    return stats;
+}
+
+SearchResult Search::think(const Position& root, const SearchLimits& limits, const std::vector<uint64_t>& keyHistory) {
+    // После arm() флаги не трогаем: их уже мог изменить stop() или ponderHit().
+    if (!m_armed.exchange(false)) arm(limits);
+    m_armed = false;
+    m_tt.newSearch();
+
+    MoveList legal;
+    generateLegalMoves(root, legal);
+    if (legal.empty()) return SearchResult();
+
+    SearchLimits searchLimits = limits;
+    searchLimits.multiPv = std::clamp(limits.multiPv, 1, legal.size);
+    std::vector<uint64_t> keys = keyHistory;
+    if (keys.empty() || keys.back() != root.key()) keys.push_back(root.key());
+    for (auto& worker : m_workers) worker->prepare(root, keys, searchLimits);
+
+    // Выигранная или проигранная позиция из таблиц эндшпиля: ход берется из них.
+    if (!limits.ponder && Tablebase::canProbe(root)) {
+        Tablebase::ProbeResult tb;
+        PackedMove move = Tablebase::bestMove(root, &tb);
+        if (move != NullMove && tb.wdl != Tablebase::WDL_DRAW) {
+            SearchResult result;
+            result.bestMove = move;
+            result.score = tb.wdl == Tablebase::WDL_WIN ? TbWinScore - tb.dtz : -TbWinScore + tb.dtz;
+            result.depth = 1;
+            result.pv.push_back(move);
+            reportProgress(result);
+            result.seconds = elapsedMs() / 1000;
+            return result;
+        }
+    }
+
+    // Вспомогательные потоки ищут, пока главный не закончит.
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < m_workers.size(); ++i) {
+        SearchWorker* worker = m_workers[i].get();
+        helpers.emplace_back([worker]() { worker->iterate(); });
+    }
+    m_workers[0]->iterate();
+    m_stop = true;
+    m_pondering = false;
+    for (std::thread& helper : helpers) helper.join();
+
+    SearchResult result = m_workers[0]->result();
+    if (result.bestMove == NullMove) result.bestMove = legal[0];  // Поиск прервали до первой итерации.
+    for (const auto& worker : m_workers) result.threadNodes.push_back(worker->publishedNodes());
+    result.stats = stats();
+    result.stats.depth = result.depth;
+    result.stats.iterationSeconds = m_workers[0]->iterationSeconds();
+    result.nodes = result.stats.totals.nodes;
+    result.seconds = result.stats.seconds;
+    m_tt.addProbeStats(result.stats.totals.ttProbes, result.stats.totals.ttHits);
+    return result;
+}
+
+bool SearchWorker::isDraw() const {
+    if (m_position.halfmoveClock() >= 100 || m_position.isInsufficientMaterial()) return true;
+    // Внутри поиска достаточно одного повторения; позиции до последнего
+    // необратимого хода (взятие, ход пешки) повториться не могут.
+    int last = static_cast<int>(m_keys.size()) - 1;
+    int first = std::max(0, last - m_position.halfmoveClock());
+    for (int i = last - 4; i >= first; i -= 2) {
+        if (m_keys[i] == m_keys[last]) return true;
+    }
+    return false;
+}
+
+// Статическая оценка: сетью, если она загружена, иначе ручной функцией.
+int SearchWorker::staticEval(int ply) const {
+    if (!m_useNnue) return evaluate(m_position);
+    // Выход сети не должен попадать в диапазон матовых оценок и оценок по таблицам.
+    const int limit = TbWinScore - MaxPly - 1;
+    return std::clamp(Nnue::evaluate(m_accumulators[ply], m_position.sideToMove()), -limit, limit);
+}
+
+void SearchWorker::makeMove(PackedMove move, UndoInfo& undo, int ply) {
+    m_position.makeMove(move, undo);
+    if (m_useNnue) Nnue::updateAccumulator(m_accumulators[ply], m_accumulators[ply + 1], m_position, move, undo);
+    m_keys.push_back(m_position.key());
+}
+
+void SearchWorker::unmakeMove(PackedMove move, const UndoInfo& undo) {
+    m_position.unmakeMove(move, undo);
+    m_keys.pop_back();
+}
+
+void SearchWorker::scoreMoves(const MoveList& moves, int scores[], PackedMove hashMove, int ply) const {
+    PieceColor us = m_position.sideToMove();
+    for (int i = 0; i < moves.size; ++i) {
+        PackedMove move = moves[i];
+        int from = moveFrom(move), to = moveTo(move);
+        Piece attacker = m_position.pieceAt(from);
+        Piece victim = m_position.pieceAt(to);
+        if (move == hashMove) {
+            scores[i] = HashMoveScore;
+        } else if (victim.type != NONE && victim.color != us) {
+            // MVV-LVA: сначала самая ценная жертва, среди равных — самый дешевый нападающий.
+            scores[i] = CaptureScore + PieceValue[victim.type] * 10 - PieceValue[attacker.type] / 10;
+        } else if (attacker.type == PAWN && to == m_position.enPassantSquare()) {
+            scores[i] = CaptureScore + PieceValue[PAWN] * 10 - PieceValue[PAWN] / 10;
+        } else if (movePromotion(move) != NONE) {
+            scores[i] = PromotionScore + PieceValue[movePromotion(move)];
+        } else if (move == m_killers[ply][0]) {
+            scores[i] = FirstKillerScore;
+        } else if (move == m_killers[ply][1]) {
+            scores[i] = SecondKillerScore;
+        } else {
+            scores[i] = m_history[us][from][to];
+        }
+    }
+}
+
+int SearchWorker::negamax(int depth, int alpha, int beta, int ply, bool allowNull) {
+    m_pvLength[ply] = ply;
+    if (depth <= 0) return quiescence(alpha, beta, ply);
+
+    if ((++m_counters.nodes % CheckLimitsInterval) == 0) checkLimits();
+    if (ply > m_counters.selDepth) m_counters.selDepth = ply;
+    if (m_stop) return 0;
+
+    bool isPvNode = beta - alpha > 1;
+    if (ply > 0) {
+        if (isDraw()) return 0;
+        // Мат ближе к корню уже найден — эта ветка не может его улучшить.
+        alpha = std::max(alpha, -MateScore + ply);
+        beta = std::min(beta, MateScore - ply - 1);
+        if (alpha >= beta) return alpha;
+    }
+    if (ply >= MaxPly - 1) return staticEval(ply);
+
+    bool inCheck = m_position.checkers() != 0;
+    if (inCheck) ++depth;  // Продление при шахе.
+
+    // Таблица перестановок: достаточно глубокая запись с подходящей границей
+    // заменяет поиск (кроме узлов главного варианта), а ее ход перебирается первым.
+    TTEntry ttEntry;
+    ++m_counters.ttProbes;
+    bool ttHit = m_tt.probe(m_position.key(), ttEntry);
+    if (ttHit) {
+        ++m_counters.ttHits;
+        int ttScore = scoreFromTT(ttEntry.score, ply);
+        if (!isPvNode && ttEntry.depth >= depth
+            && (ttEntry.bound == BOUND_EXACT
+                || (ttEntry.bound == BOUND_LOWER && ttScore >= beta)
+                || (ttEntry.bound == BOUND_UPPER && ttScore <= alpha))) {
+            return ttScore;
+        }
+    }
+    PackedMove hashMove = ttHit ? ttEntry.move : NullMove;
+
+    // Таблицы эндшпиля: после взятия или хода пешкой исход позиции известен точно.
+    // Таблицы не учитывают правило 50 ходов, поэтому в остальных узлах их не спрашиваем.
+    if (ply > 0 && m_position.halfmoveClock() == 0 && Tablebase::canProbe(m_position)) {
+        Tablebase::Wdl wdl;
+        if (Tablebase::probeWdl(m_position, wdl)) {
+            int score = wdl == Tablebase::WDL_WIN ? TbWinScore - ply : wdl == Tablebase::WDL_LOSS ? -TbWinScore + ply : 0;
+            m_tt.store(m_position.key(), std::min(depth + 6, MaxSearchDepth), BOUND_EXACT, scoreToTT(score, ply), NullMove);
+            return score;
+        }
+    }
+
+    // Нулевой ход: если даже после пропуска хода оценка не ниже beta, ветку можно отсечь.
+    // В эндшпиле без фигур не применяется из-за цугцванга.
+    if (allowNull && !isPvNode && !inCheck && depth >= 3
+        && hasNonPawnMaterial(m_position, m_position.sideToMove())
+        && staticEval(ply) >= beta) {
+        int reduction = depth >= 7 ? 3 : 2;
+        UndoInfo undo;
+        m_position.makeNullMove(undo);
+        if (m_useNnue) m_accumulators[ply + 1] = m_accumulators[ply];
+        m_keys.push_back(m_position.key());
+        int score = -negamax(depth - 1 - reduction, -beta, -beta + 1, ply + 1, false);
+        m_keys.pop_back();
+        m_position.unmakeNullMove(undo);
+        if (m_stop) return 0;
+        if (score >= beta) return isMateScore(score) ? beta : score;
+    }
+
+    MoveList moves;
+    generatePseudoLegalMoves(m_position, moves);
+    int scores[256];
+    scoreMoves(moves, scores, hashMove, ply);
+
+    int originalAlpha = alpha;
+    int bestScore = -Infinity;
+    PackedMove bestMove = NullMove;
+    int legalCount = 0;
+    PieceColor us = m_position.sideToMove();
+    for (int i = 0; i < moves.size; ++i) {
+        pickNextMove(moves, scores, i);
+        PackedMove move = moves[i];
+        if (!m_position.isLegal(move)) continue;
+        if (ply == 0 && !m_excludedRootMoves.empty() && isExcludedRootMove(move)) continue;
+        ++legalCount;
+
+        Piece target = m_position.pieceAt(moveTo(move));
+        bool isQuiet = (target.type == NONE || target.color == us) && movePromotion(move) == NONE
+                       && !(m_position.pieceAt(moveFrom(move)).type == PAWN && moveTo(move) == m_position.enPassantSquare());
+
+        UndoInfo undo;
+        makeMove(move, undo, ply);
+        int score;
+        if (legalCount == 1) {
+            score = -negamax(depth - 1, -beta, -alpha, ply + 1, true);
+        } else {
+            // PVS: остальные ходы сначала проверяются нулевым окном.
+            score = -negamax(depth - 1, -alpha - 1, -alpha, ply + 1, true);
+            if (score > alpha && score < beta) score = -negamax(depth - 1, -beta, -alpha, ply + 1, true);
+        }
+        unmakeMove(move, undo);
+        if (m_stop) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                bestMove = move;
+                m_pv[ply][ply] = move;
+                for (int next = ply + 1; next < m_pvLength[ply + 1]; ++next) m_pv[ply][next] = m_pv[ply + 1][next];
+                m_pvLength[ply] = std::max(m_pvLength[ply + 1], ply + 1);
+                if (alpha >= beta) {
+                    ++m_counters.betaCutoffs;
+                    if (legalCount == 1) ++m_counters.firstMoveCutoffs;
+                    if (isQuiet) {
+                        if (m_killers[ply][0] != move) {
+                            m_killers[ply][1] = m_killers[ply][0];
+                            m_killers[ply][0] = move;
+                        }
+                        int& history = m_history[us][moveFrom(move)][moveTo(move)];
+                        history = std::min(history + depth * depth, HistoryLimit);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (legalCount == 0) return inCheck ? -MateScore + ply : 0;
+
+    // Корень без исключенных ходов multi-PV — не та же позиция: в таблицу не пишем.
+    if (ply == 0 && !m_excludedRootMoves.empty()) return bestScore;
+    TTBound bound = bestScore >= beta ? BOUND_LOWER : (bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER);
+    m_tt.store(m_position.key(), depth, bound, scoreToTT(bestScore, ply), bestMove);
+    return bestScore;
+}
+
+int SearchWorker::quiescence(int alpha, int beta, int ply) {
+    m_pvLength[ply] = ply;
+    if ((++m_counters.nodes % CheckLimitsInterval) == 0) checkLimits();
+    ++m_counters.qnodes;
+    if (ply > m_counters.selDepth) m_counters.selDepth = ply;
+    if (m_stop) return 0;
+    if (ply >= MaxPly - 1) return staticEval(ply);
+
+    // Под шахом оценке "стоя на месте" верить нельзя: перебираются все ответы на шах.
+    bool inCheck = m_position.checkers() != 0;
+    int bestScore;
+    MoveList moves;
+    if (inCheck) {
+        bestScore = -MateScore + ply;
+        generatePseudoLegalMoves(m_position, moves);
+    } else {
+        bestScore = staticEval(ply);
+        if (bestScore >= beta) return bestScore;
+        alpha = std::max(alpha, bestScore);
+        generatePseudoLegalCaptures(m_position, moves);
+    }
+
+    int scores[256];
+    scoreMoves(moves, scores, NullMove, ply);
+    for (int i = 0; i < moves.size; ++i) {
+        pickNextMove(moves, scores, i);
+        PackedMove move = moves[i];
+        if (!m_position.isLegal(move)) continue;
+
+        UndoInfo undo;
+        makeMove(move, undo, ply);
+        int score = -quiescence(-beta, -alpha, ply + 1);
+        unmakeMove(move, undo);
+        if (m_stop) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                m_pv[ply][ply] = move;
+                for (int next = ply + 1; next < m_pvLength[ply + 1]; ++next) m_pv[ply][next] = m_pv[ply + 1][next];
+                m_pvLength[ply] = std::max(m_pvLength[ply + 1], ply + 1);
+                if (alpha >= beta) break;
+            }
+        }
+    }
+    return bestScore;
+}
@@ -0,0 +1,183 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "position.h"
+#include "movegen.h"
+#include "transposition_table.h"
+#include "nnue.h"
+#include "search_stats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Ограничения поиска (0 — без ограничения). Сила игры бота задается именно ими:
+// глубиной, числом узлов или временем на ход.
+struct SearchLimits {
+    int depth = 0;          // Максимальная глубина в полуходах.
+    uint64_t nodes = 0;     // Максимальное число узлов.
+    int moveTimeMs = 0;     // Время на ход в миллисекундах.
+    // Обдумывание на ходу соперника: лимиты начинают действовать только после
+    // Search::ponderHit(), а до него поиск не заканчивается сам (только по stop()).
+    bool ponder = false;
+    // Сколько лучших ходов корня искать (анализ партии): вариант k ищется без ходов
+    // вариантов 1..k-1. Больше 1 — поиск соответственно дольше.
+    int multiPv = 1;
+};
+
+// Один из вариантов multi-PV.
+struct SearchLine {
+    int score = 0;
+    std::vector<PackedMove> pv;
+};
+
+struct SearchResult {
+    PackedMove bestMove = NullMove; // NullMove, если легальных ходов нет.
+    int score = 0;          // В сотых пешки с точки зрения стороны, которой ходить.
+    int depth = 0;          // Последняя полностью просчитанная глубина.
+    uint64_t nodes = 0;
+    double seconds = 0;
+    std::vector<PackedMove> pv; // Главный вариант, начиная с bestMove.
+    std::vector<uint64_t> threadNodes; // Узлы по потокам (индекс 0 — главный поток).
+    SearchStats stats;          // Счетчики всех потоков и время итераций.
+    std::vector<SearchLine> lines; // Варианты по убыванию оценки; первый — score и pv (при multiPv > 1).
+};
+
+const int MateScore = 32000;  // Мат в n полуходов оценивается как ±(MateScore - n).
+const int MaxPly = 128;
+const int MaxSearchDepth = 64;
+// Выигрыш по таблицам эндшпиля в n полуходах от корня: ±(TbWinScore - n), ниже любого мата.
+const int TbWinScore = MateScore - 2 * MaxPly;
+
+inline bool isMateScore(int score) { return score > MateScore - MaxPly || score < -MateScore + MaxPly; }
+
+class Search;
+
+// Вызывается из потока поиска после каждой завершенной итерации главного потока;
+// nodes и seconds — по всем потокам с начала поиска.
+using SearchProgress = std::function<void(const SearchResult&)>;
+
+/**
+ * @class SearchWorker
+ * @brief Состояние поиска одного потока: своя копия позиции, стек хешей,
+ *        killer-ходы, история, главный вариант и стек аккумуляторов сети. Таблица перестановок и флаг
+ *        остановки общие для всех потоков (принадлежат Search).
+ */
+class SearchWorker
+{
+public:
+    SearchWorker(int id, Search& owner);
+
+    void prepare(const Position& root, const std::vector<uint64_t>& keys, const SearchLimits& limits);
+    void iterate();                         // Итеративное углубление до остановки или лимита глубины.
+
+    const SearchResult& result() const { return m_result; }
+    // Счетчики обновляются раз в несколько тысяч узлов (читаются из других потоков).
+    uint64_t publishedNodes() const { return m_published.nodes(); }
+    SearchCounters publishedCounters() const { return m_published.load(); }
+    // Длительности итераций главного потока; читать только из потока поиска.
+    const std::vector<double>& iterationSeconds() const { return m_iterationSeconds; }
+
+private:
+    int negamax(int depth, int alpha, int beta, int ply, bool allowNull);
+    int quiescence(int alpha, int beta, int ply);
+    void searchOtherLines(int depth);       // Варианты 2..multiPv завершенной итерации.
+    bool isExcludedRootMove(PackedMove move) const;
+    bool isDraw() const;
+    void checkLimits();
+    void scoreMoves(const MoveList& moves, int scores[], PackedMove hashMove, int ply) const;
+    int staticEval(int ply) const;
+    void makeMove(PackedMove move, UndoInfo& undo, int ply);
+    void unmakeMove(PackedMove move, const UndoInfo& undo);
+
+    int m_id;                               // 0 — главный поток: следит за лимитами, его результат — итог.
+    Search& m_owner;
+    TranspositionTable& m_tt;
+    std::atomic<bool>& m_stop;
+
+    Position m_position;
+    std::vector<uint64_t> m_keys;           // Хеши позиций партии и текущего варианта.
+    SearchLimits m_limits;
+    std::vector<PackedMove> m_excludedRootMoves; // Ходы корня уже найденных вариантов multi-PV.
+    SearchResult m_result;
+    SearchCounters m_counters;              // Счетчики текущего поиска (пишет только этот поток).
+    PublishedCounters m_published;
+    std::vector<double> m_iterationSeconds;
+    int m_rootDepth;
+    bool m_useNnue;                         // Оценка сетью (если загружена на момент старта поиска).
+
+    PackedMove m_killers[MaxPly][2];        // Тихие ходы, вызвавшие отсечение на этом уровне.
+    int m_history[3][64][64];               // [цвет][откуда][куда]: успешность тихих ходов.
+
+    PackedMove m_pv[MaxPly][MaxPly];        // Треугольная таблица главного варианта.
+    int m_pvLength[MaxPly];
+
+    Nnue::Accumulator m_accumulators[MaxPly + 1]; // Первый слой сети по уровням текущего варианта.
+};
+
+/**
+ * @class Search
+ * @brief Поиск лучшего хода: negamax с альфа-бета отсечением.
+ *
+ * Итеративное углубление, поиск главного варианта (PVS), форсированный поиск
+ * взятий в листьях, отсечение нулевым ходом и продление при шахе. Результаты узлов
+ * кешируются в таблице перестановок. Порядок ходов: ход из таблицы, взятия по MVV-LVA,
+ * превращения, killer-ходы и история отсечений. Не зависит от Qt.
+ *
+ * Многопоточность по схеме Lazy SMP: каждый поток (SearchWorker) независимо ищет
+ * из той же позиции, а обмениваются они только через общую таблицу перестановок.
+ * Половина вспомогательных потоков начинает с глубины на единицу больше, чтобы
+ * потоки расходились по дереву. Итог и контроль времени — за главным потоком.
+ */
+class Search
+{
+public:
+    static constexpr int MaxThreads = 256;
+
+    Search();
+    ~Search();
+
+    // keyHistory — хеши позиций партии до корневой (для повторений), можно не передавать.
+    SearchResult think(const Position& root, const SearchLimits& limits,
+                       const std::vector<uint64_t>& keyHistory = std::vector<uint64_t>());
+    // Готовит поиск с limits в вызывающем потоке до запуска think в другом: stop() и
+    // ponderHit(), пришедшие раньше, чем поток дойдет до think, тогда не теряются.
+    void arm(const SearchLimits& limits);
+    // Прерывает think из другого потока; вернется лучший ход последней итерации.
+    void stop() { m_stop = true; }
+    // Соперник сделал ожидаемый ход: обдумывание становится обычным поиском,
+    // время на ход отсчитывается с этого момента. Вызывается из другого потока.
+    void ponderHit();
+    // Задается до think; вызывается в потоке поиска.
+    void setProgressCallback(SearchProgress callback) { m_progress = std::move(callback); }
+
+    void setThreads(int count);             // Число потоков поиска (1..MaxThreads).
+    int threads() const { return static_cast<int>(m_workers.size()); }
+    uint64_t nodesSearched() const;         // Узлы всех потоков текущего поиска.
+    // Счетчики всех потоков текущего поиска, собранные без блокировок; можно
+    // вызывать из другого потока во время поиска. Время итераций — в SearchResult::stats.
+    SearchStats stats() const;
+
+    // Таблица перестановок сохраняется между вызовами think (до clear/resize).
+    void setHashSizeMb(size_t sizeMb) { m_tt.resize(sizeMb); }
+    TranspositionTable& transpositionTable() { return m_tt; }
+
+private:
+    friend class SearchWorker;
+
+    double elapsedMs() const;
+    void reportProgress(const SearchResult& iteration) const;
+
+    TranspositionTable m_tt;
+    std::atomic<bool> m_stop;
+    std::atomic<bool> m_pondering;
+    std::atomic<bool> m_armed;              // arm() уже сбросил флаги для ближайшего think.
+    // Начало отсчета времени (тики steady_clock); ponderHit переносит его из другого потока.
+    std::atomic<std::chrono::steady_clock::rep> m_startTicks;
+    SearchProgress m_progress;
+    std::vector<std::unique_ptr<SearchWorker>> m_workers;
+};
+
+#endif // SEARCH_H
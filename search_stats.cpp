@@ -0,0 +1,55 @@
+#include "search_stats.h"
+#include <algorithm>
+#include <cstdio>
+
+void SearchCounters::add(const SearchCounters& other) {
+    nodes += other.nodes;
+    qnodes += other.qnodes;
+    ttProbes += other.ttProbes;
+    ttHits += other.ttHits;
+    betaCutoffs += other.betaCutoffs;
+    firstMoveCutoffs += other.firstMoveCutoffs;
+    selDepth = std::max(selDepth, other.selDepth);
+}
+
+void PublishedCounters::publish(const SearchCounters& counters) {
+    m_nodes.store(counters.nodes, std::memory_order_relaxed);
+    m_qnodes.store(counters.qnodes, std::memory_order_relaxed);
+    m_ttProbes.store(counters.ttProbes, std::memory_order_relaxed);
+    m_ttHits.store(counters.ttHits, std::memory_order_relaxed);
+    m_betaCutoffs.store(counters.betaCutoffs, std::memory_order_relaxed);
+    m_firstMoveCutoffs.store(counters.firstMoveCutoffs, std::memory_order_relaxed);
+    m_selDepth.store(counters.selDepth, std::memory_order_relaxed);
+}
+
+SearchCounters PublishedCounters::load() const {
+    SearchCounters counters;
+    counters.nodes = m_nodes.load(std::memory_order_relaxed);
+    counters.qnodes = m_qnodes.load(std::memory_order_relaxed);
+    counters.ttProbes = m_ttProbes.load(std::memory_order_relaxed);
+    counters.ttHits = m_ttHits.load(std::memory_order_relaxed);
+    counters.betaCutoffs = m_betaCutoffs.load(std::memory_order_relaxed);
+    counters.firstMoveCutoffs = m_firstMoveCutoffs.load(std::memory_order_relaxed);
+    counters.selDepth = m_selDepth.load(std::memory_order_relaxed);
+    return counters;
+}
+
+std::string SearchStats::toJson() const {
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+                  "{\"depth\":%d,\"seldepth\":%d,\"threads\":%d,\"seconds\":%.6f,\"nodes\":%llu,\"nps\":%.0f,"
+                  "\"qnodes\":%llu,\"qnodeShare\":%.4f,\"ttProbes\":%llu,\"ttHits\":%llu,\"ttHitRate\":%.4f,"
+                  "\"betaCutoffs\":%llu,\"firstMoveCutoffs\":%llu,\"firstMoveCutoffRate\":%.4f,\"iterationSeconds\":[",
+                  depth, totals.selDepth, threads, seconds, static_cast<unsigned long long>(totals.nodes), nps(),
+                  static_cast<unsigned long long>(totals.qnodes), qnodeShare(),
+                  static_cast<unsigned long long>(totals.ttProbes), static_cast<unsigned long long>(totals.ttHits), ttHitRate(),
+                  static_cast<unsigned long long>(totals.betaCutoffs), static_cast<unsigned long long>(totals.firstMoveCutoffs),
+                  firstMoveCutoffRate());
+    std::string json = buffer;
+    for (size_t i = 0; i < iterationSeconds.size(); ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%s%.6f", i ? "," : "", iterationSeconds[i]);
+        json += buffer;
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,65 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Счетчики одного потока поиска. Поток пишет в них обычными инкрементами, без синхронизации.
+struct SearchCounters {
+    uint64_t nodes = 0;             // Все узлы, включая форсированный поиск.
+    uint64_t qnodes = 0;            // Узлы форсированного поиска взятий.
+    uint64_t ttProbes = 0;          // Обращения к таблице перестановок.
+    uint64_t ttHits = 0;
+    uint64_t betaCutoffs = 0;       // Отсечения по beta при переборе ходов.
+    uint64_t firstMoveCutoffs = 0;  // Из них — на первом же легальном ходе.
+    int selDepth = 0;               // Наибольшее расстояние от корня в полуходах.
+
+    void add(const SearchCounters& other);
+};
+
+/**
+ * @class PublishedCounters
+ * @brief Копия счетчиков потока, доступная другим потокам.
+ *
+ * Поток-владелец переписывает ее раз в несколько тысяч узлов (вместе с проверкой
+ * лимитов), остальные читают в любой момент. Все операции relaxed: блокировок нет,
+ * а горячий путь поиска не трогает общую память. Поля снимка могут быть
+ * из соседних публикаций — для статистики это допустимо.
+ */
+class PublishedCounters
+{
+public:
+    void publish(const SearchCounters& counters);
+    SearchCounters load() const;
+    uint64_t nodes() const { return m_nodes.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_nodes{0};
+    std::atomic<uint64_t> m_qnodes{0};
+    std::atomic<uint64_t> m_ttProbes{0};
+    std::atomic<uint64_t> m_ttHits{0};
+    std::atomic<uint64_t> m_betaCutoffs{0};
+    std::atomic<uint64_t> m_firstMoveCutoffs{0};
+    std::atomic<int> m_selDepth{0};
+};
+
+// Статистика поиска по всем потокам: для панели бота, bench и UCI.
+struct SearchStats {
+    SearchCounters totals;          // Сумма по потокам; selDepth — наибольшая.
+    int threads = 0;
+    int depth = 0;                  // Последняя завершенная итерация главного потока.
+    double seconds = 0;
+    std::vector<double> iterationSeconds; // Длительность каждой завершенной итерации (с глубины 1).
+
+    double nps() const { return seconds > 0 ? totals.nodes / seconds : 0.0; }
+    double ttHitRate() const { return totals.ttProbes ? double(totals.ttHits) / totals.ttProbes : 0.0; }
+    double firstMoveCutoffRate() const { return totals.betaCutoffs ? double(totals.firstMoveCutoffs) / totals.betaCutoffs : 0.0; }
+    double qnodeShare() const { return totals.nodes ? double(totals.qnodes) / totals.nodes : 0.0; }
+
+    // Одна строка JSON: {"depth":7,"seldepth":19,"nodes":...,"iterationSeconds":[...]}.
+    std::string toJson() const;
+};
+
+#endif // SEARCH_STATS_H
@@ -0,0 +1,24 @@
+#include "startpos.h"
+
+int chess960PositionIndex(const PieceType backRank[8]) {
+    for (int sp = 0; sp < Chess960PositionCount; ++sp) {
+        const StartPosition& candidate = chess960StartPosition(sp);
+        bool same = true;
+        for (int col = 0; col < 8 && same; ++col) same = candidate.backRank[col] == backRank[col];
+        if (same) return sp;
+    }
+    return -1;
+}
+
+void setupStartPosition(Position& position, int spIndex) {
+    const StartPosition& sp = chess960StartPosition(spIndex);
+    position.clear();
+    for (int col = 0; col < 8; ++col) {
+        position.putPiece(makeSquare(0, col), {sp.backRank[col], BLACK});
+        position.putPiece(makeSquare(1, col), {PAWN, BLACK});
+        position.putPiece(makeSquare(6, col), {PAWN, WHITE});
+        position.putPiece(makeSquare(7, col), {sp.backRank[col], WHITE});
+    }
+    position.setCastlingFiles(sp.kingCol, sp.longRookCol, sp.shortRookCol);
+    position.updateAttackInfo();
+}
@@ -0,0 +1,83 @@
+#ifndef STARTPOS_H
+#define STARTPOS_H
+
+#include "position.h"
+#include <array>
+
+// Количество стартовых позиций Chess960 и номер классической расстановки (RNBQKBNR).
+const int Chess960PositionCount = 960;
+const int ClassicalStartPosition = 518;
+
+// Первая горизонталь стартовой позиции и исходные вертикали короля и ладей.
+struct StartPosition {
+    PieceType backRank[8];
+    int kingCol;
+    int longRookCol;  // Ладья со стороны вертикали a.
+    int shortRookCol; // Ладья со стороны вертикали h.
+};
+
+namespace StartPositionTables {
+
+// Расстановки двух коней на пяти свободных клетках.
+constexpr int KnightPlacements[10][2] = {
+    {0, 1}, {0, 2}, {0, 3}, {0, 4}, {1, 2}, {1, 3}, {1, 4}, {2, 3}, {2, 4}, {3, 4}
+};
+
+// Ставит фигуру на index-ю по счету свободную клетку.
+constexpr void placeOnEmpty(StartPosition& sp, int index, PieceType type) {
+    for (int col = 0; col < 8; ++col) {
+        if (sp.backRank[col] != NONE) continue;
+        if (index-- == 0) { sp.backRank[col] = type; return; }
+    }
+}
+
+// Нумерация Шарнагля: номер последовательно раскладывается на
+// положение слона на белых полях, слона на черных полях, ферзя и пары коней;
+// на оставшиеся три клетки встают ладья, король, ладья.
+constexpr StartPosition decode(int spIndex) {
+    StartPosition sp{};
+    for (int col = 0; col < 8; ++col) sp.backRank[col] = NONE;
+    int n = spIndex;
+    sp.backRank[(n % 4) * 2 + 1] = BISHOP; n /= 4; // Вертикали b, d, f, h.
+    sp.backRank[(n % 4) * 2] = BISHOP;     n /= 4; // Вертикали a, c, e, g.
+    placeOnEmpty(sp, n % 6, QUEEN); n /= 6;
+    // Второго коня ставим первым, чтобы индекс первого не сдвинулся.
+    placeOnEmpty(sp, KnightPlacements[n][1], KNIGHT);
+    placeOnEmpty(sp, KnightPlacements[n][0], KNIGHT);
+    placeOnEmpty(sp, 0, ROOK);
+    placeOnEmpty(sp, 0, KING);
+    placeOnEmpty(sp, 0, ROOK);
+
+    sp.kingCol = sp.longRookCol = sp.shortRookCol = -1;
+    for (int col = 0; col < 8; ++col) {
+        if (sp.backRank[col] == KING) sp.kingCol = col;
+        else if (sp.backRank[col] == ROOK && sp.kingCol == -1) sp.longRookCol = col;
+        else if (sp.backRank[col] == ROOK) sp.shortRookCol = col;
+    }
+    return sp;
+}
+
+constexpr std::array<StartPosition, Chess960PositionCount> makeTable() {
+    std::array<StartPosition, Chess960PositionCount> table{};
+    for (int i = 0; i < Chess960PositionCount; ++i) table[i] = decode(i);
+    return table;
+}
+
+// Все 960 стартовых позиций, строятся при компиляции.
+inline constexpr std::array<StartPosition, Chess960PositionCount> All = makeTable();
+
+static_assert(All[ClassicalStartPosition].backRank[0] == ROOK && All[ClassicalStartPosition].backRank[3] == QUEEN
+              && All[ClassicalStartPosition].kingCol == 4, "SP 518 must be RNBQKBNR");
+
+} // namespace StartPositionTables
+
+// Стартовая позиция с номером Шарнагля spIndex (0..959).
+inline const StartPosition& chess960StartPosition(int spIndex) { return StartPositionTables::All[spIndex]; }
+
+// Номер Шарнагля для расстановки первой горизонтали или -1, если это не позиция Chess960.
+int chess960PositionIndex(const PieceType backRank[8]);
+
+// Полная стартовая позиция с номером spIndex: фигуры, пешки, права на рокировку.
+void setupStartPosition(Position& position, int spIndex);
+
+#endif // STARTPOS_H
@@ -0,0 +1,564 @@
+#include "tablebase.h"
+#include "mapped_file.h"
+#include "movegen.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace Tablebase {
+
+namespace {
+
+/*
+ * Формат файла (little-endian):
+ *   char[4]  "C9TB"
+ *   uint32   версия (1)
+ *   char[16] материал ("KQvKR", дополнен нулями)
+ *   uint64   позиций на сторону
+ *   uint32   позиций в блоке
+ *   uint32   байт на значение DTZ (1 или 2)
+ *   uint64   смещения четырех разделов: [сторона][WDL, DTZ]
+ * Раздел: uint64 смещения блоков (их число + 1) относительно начала данных раздела,
+ * затем блоки. Блок — последовательность пар (длина серии в varint, значение).
+ * WDL: 0 — проигрыш, 1 — ничья, 2 — выигрыш. Внутри блока значение ищется
+ * линейным проходом по сериям; недопустимые позиции (и DTZ ничьих) продолжают
+ * соседние серии, поэтому серий немного.
+ */
+const char FileMagic[4] = { 'C', '9', 'T', 'B' };
+const uint32_t FileVersion = 1;
+const size_t HeaderSize = 72;
+const size_t NameSize = 16;
+const uint32_t BlockSize = 2048;
+
+const PieceType TypeOrder[] = { QUEEN, ROOK, BISHOP, KNIGHT, PAWN };
+const char TypeLetters[] = " KQRBNP";  // Индекс — PieceType.
+
+bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// Симметрии доски: биты — отражение по горизонтали, по вертикали, транспонирование.
+int transformSquare(int square, int transform) {
+    int row = squareRow(square), col = squareCol(square);
+    if (transform & 1) col = 7 - col;
+    if (transform & 2) row = 7 - row;
+    if (transform & 4) std::swap(row, col);
+    return makeSquare(row, col);
+}
+
+bool isCanonicalKing(int square, bool pawns) {
+    int row = squareRow(square), col = squareCol(square);
+    if (pawns) return col <= 3;
+    return row <= 3 && col <= 3 && row <= col;
+}
+
+// Допустимые пары королей (не на одной и не на соседних клетках) при каноническом
+// белом короле: [есть пешки][белый][черный] -> номер пары и обратно.
+int g_kingPairIndex[2][64][64];
+int g_kingPairCount[2];
+uint8_t g_kingPairSquares[2][64 * 64][2];
+
+struct KingPairsInit {
+    KingPairsInit() {
+        for (int pawns = 0; pawns < 2; ++pawns) {
+            g_kingPairCount[pawns] = 0;
+            for (int white = 0; white < 64; ++white) {
+                for (int black = 0; black < 64; ++black) {
+                    g_kingPairIndex[pawns][white][black] = -1;
+                    if (!isCanonicalKing(white, pawns) || white == black || (kingAttacks(white) & squareBB(black))) continue;
+                    int pair = g_kingPairCount[pawns]++;
+                    g_kingPairIndex[pawns][white][black] = pair;
+                    g_kingPairSquares[pawns][pair][0] = static_cast<uint8_t>(white);
+                    g_kingPairSquares[pawns][pair][1] = static_cast<uint8_t>(black);
+                }
+            }
+        }
+    }
+} kingPairsInit;
+
+bool samePiece(Piece a, Piece b) { return a.type == b.type && a.color == b.color; }
+
+// Значение для раздела файла или -1, если оно неважно (недопустимая позиция, DTZ ничьей).
+int streamValue(uint16_t code, int stream) {
+    if (stream == 0) {
+        if (code == ValueIllegal) return -1;
+        if (code >= WinBase) return 2;
+        if (code >= LossBase) return 0;
+        return 1;
+    }
+    return code >= LossBase ? (code & 0x3FFF) : -1;
+}
+
+void appendRun(std::vector<unsigned char>& data, uint64_t length, int value, int valueBytes) {
+    while (length >= 0x80) {
+        data.push_back(static_cast<unsigned char>(length | 0x80));
+        length >>= 7;
+    }
+    data.push_back(static_cast<unsigned char>(length));
+    for (int i = 0; i < valueBytes; ++i) data.push_back(static_cast<unsigned char>(value >> (8 * i)));
+}
+
+// Раздел целиком: таблица смещений блоков и сами блоки.
+std::vector<unsigned char> compressSection(uint64_t size, int side, int stream, int valueBytes,
+                                           const std::function<uint16_t(int, uint64_t)>& value) {
+    uint64_t blockCount = (size + BlockSize - 1) / BlockSize;
+    std::vector<unsigned char> offsets((blockCount + 1) * 8);
+    std::vector<unsigned char> data;
+    for (uint64_t block = 0; block < blockCount; ++block) {
+        writeLittleEndian(&offsets[block * 8], data.size(), 8);
+        uint64_t begin = block * BlockSize;
+        uint64_t end = std::min(size, begin + BlockSize);
+        uint64_t runLength = 0, pending = 0;
+        int runValue = 0;
+        for (uint64_t index = begin; index < end; ++index) {
+            int v = streamValue(value(side, index), stream);
+            if (v < 0) {
+                if (runLength) ++runLength;
+                else ++pending;
+            } else if (runLength && v == runValue) {
+                ++runLength;
+            } else {
+                if (runLength) appendRun(data, runLength, runValue, valueBytes);
+                runValue = v;
+                runLength = pending + 1;
+                pending = 0;
+            }
+        }
+        if (!runLength) runLength = pending; // Весь блок неважен.
+        appendRun(data, runLength, runValue, valueBytes);
+    }
+    writeLittleEndian(&offsets[blockCount * 8], data.size(), 8);
+    offsets.insert(offsets.end(), data.begin(), data.end());
+    return offsets;
+}
+
+struct Table {
+    explicit Table(const Material& m) : material(m), layout(m) {}
+
+    // Значение позиции index стороны side из раздела stream (0 — WDL, 1 — DTZ).
+    unsigned value(int side, int stream, uint64_t index) const {
+        const unsigned char* offsets = sections[side][stream];
+        const unsigned char* data = offsets + (blockCount + 1) * 8;
+        uint64_t block = index / blockSize;
+        uint64_t remaining = index % blockSize;
+        const unsigned char* run = data + readLittleEndian(offsets + block * 8, 8);
+        const unsigned char* end = data + readLittleEndian(offsets + (block + 1) * 8, 8);
+        int valueBytes = stream == 0 ? 1 : dtzBytes;
+        while (run < end) {
+            uint64_t length = 0;
+            int shift = 0;
+            unsigned char byte;
+            do {
+                byte = *run++;
+                length |= uint64_t(byte & 0x7F) << shift;
+                shift += 7;
+            } while ((byte & 0x80) && run < end);
+            unsigned v = static_cast<unsigned>(readLittleEndian(run, valueBytes));
+            run += valueBytes;
+            if (remaining < length) return v;
+            remaining -= length;
+        }
+        return stream == 0 ? 1 : 0; // Поврежденный блок: считаем ничьей.
+    }
+
+    Material material;
+    Layout layout;
+    MappedFile file;
+    uint32_t blockSize = BlockSize;
+    uint64_t blockCount = 0;
+    int dtzBytes = 1;
+    const unsigned char* sections[2][2] = {};
+};
+
+std::unordered_map<uint64_t, std::unique_ptr<Table>> g_tables;
+int g_largest = 0;
+
+bool loadTable(const std::string& path, const Material& material, Table& table) {
+    if (!table.file.open(path, true)) return false;
+    const unsigned char* data = table.file.data();
+    size_t size = table.file.size();
+    if (size < HeaderSize || std::memcmp(data, FileMagic, sizeof(FileMagic)) != 0
+        || readLittleEndian(data + 4, 4) != FileVersion) return false;
+    char name[NameSize + 1] = {};
+    std::memcpy(name, data + 8, NameSize);
+    if (material.name() != name || readLittleEndian(data + 24, 8) != table.layout.size()) return false;
+
+    table.blockSize = static_cast<uint32_t>(readLittleEndian(data + 32, 4));
+    table.dtzBytes = static_cast<int>(readLittleEndian(data + 36, 4));
+    if (table.blockSize == 0 || (table.dtzBytes != 1 && table.dtzBytes != 2)) return false;
+    table.blockCount = (table.layout.size() + table.blockSize - 1) / table.blockSize;
+    for (int section = 0; section < 4; ++section) {
+        uint64_t offset = readLittleEndian(data + 40 + section * 8, 8);
+        uint64_t tableBytes = (table.blockCount + 1) * 8;
+        if (offset > size || tableBytes > size - offset) return false;
+        if (readLittleEndian(data + offset + table.blockCount * 8, 8) > size - offset - tableBytes) return false;
+        table.sections[section / 2][section % 2] = data + offset;
+    }
+    return true;
+}
+
+const Table* findTable(const Position& position, int& side, uint64_t& index) {
+    Material material = Material::of(position);
+    bool flip = !material.isCanonical();
+    if (flip) material = material.flipped();
+    auto it = g_tables.find(material.id());
+    if (it == g_tables.end()) return nullptr;
+    index = it->second->layout.encode(position, flip);
+    if (index == Layout::InvalidIndex) return nullptr;
+    side = (position.sideToMove() == WHITE) != flip ? 0 : 1;
+    return it->second.get();
+}
+
+// Оценка через ходы из позиции: для корня и для позиций с правом взятия на проходе.
+bool probeByMoves(const Position& position, ProbeResult& result, PackedMove* bestMove) {
+    MoveList moves;
+    generateLegalMoves(position, moves);
+    if (moves.size == 0) {
+        result.wdl = position.checkers() ? WDL_LOSS : WDL_DRAW;
+        result.dtz = 0;
+        return true;
+    }
+
+    Position child = position;
+    PackedMove best = NullMove;
+    int bestKey = 0;
+    for (PackedMove move : moves) {
+        UndoInfo undo;
+        child.makeMove(move, undo);
+        bool zeroing = undo.captured.type != NONE || undo.moved.type == PAWN;
+        bool mate = child.checkers() && !hasAnyLegalMove(child);
+        ProbeResult reply;
+        bool found = zeroing ? probeWdl(child, reply.wdl) : probe(child, reply);
+        child.unmakeMove(move, undo);
+        if (!found) return false;
+
+        // Выигрыш: мат, затем кратчайший путь к обнуляющему ходу; проигрыш — длиннейший.
+        int wdl = -reply.wdl;
+        int dtz = zeroing || mate ? 1 : reply.dtz + 1;
+        int key = wdl == WDL_WIN ? (mate ? 1000000 : 500000 - dtz) : wdl == WDL_DRAW ? 0 : -500000 + dtz;
+        if (best == NullMove || key > bestKey) {
+            best = move;
+            bestKey = key;
+            result.wdl = static_cast<Wdl>(wdl);
+            result.dtz = wdl == WDL_DRAW ? 0 : dtz;
+        }
+    }
+    if (bestMove) *bestMove = best;
+    return true;
+}
+
+} // namespace
+
+Material Material::of(const Position& position) {
+    Material material;
+    for (PieceColor color : { WHITE, BLACK }) {
+        for (int type = KING; type <= PAWN; ++type) {
+            material.counts[color][type] = popCount(position.pieces(color, static_cast<PieceType>(type)));
+        }
+    }
+    return material;
+}
+
+bool Material::parse(const std::string& name, Material& material) {
+    material = Material();
+    size_t separator = name.find('v');
+    if (separator == std::string::npos) return false;
+    const std::string sides[2] = { name.substr(0, separator), name.substr(separator + 1) };
+    for (int i = 0; i < 2; ++i) {
+        PieceColor color = i == 0 ? WHITE : BLACK;
+        if (sides[i].empty() || sides[i][0] != 'K') return false;
+        for (char letter : sides[i]) {
+            const char* found = letter ? std::strchr(TypeLetters + 1, letter) : nullptr;
+            if (!found) return false;
+            ++material.counts[color][found - TypeLetters];
+        }
+        if (material.counts[color][KING] != 1) return false;
+    }
+    return material.pieceCount() <= MaxPieces;
+}
+
+std::string Material::name() const {
+    std::string result;
+    for (PieceColor color : { WHITE, BLACK }) {
+        if (color == BLACK) result += 'v';
+        result += 'K';
+        for (PieceType type : TypeOrder) result.append(counts[color][type], TypeLetters[type]);
+    }
+    return result;
+}
+
+int Material::pieceCount() const {
+    int count = 0;
+    for (PieceColor color : { WHITE, BLACK }) {
+        for (int type = KING; type <= PAWN; ++type) count += counts[color][type];
+    }
+    return count;
+}
+
+bool Material::hasPawns() const {
+    return counts[WHITE][PAWN] + counts[BLACK][PAWN] > 0;
+}
+
+bool Material::isCanonical() const {
+    for (PieceType type : TypeOrder) {
+        if (counts[WHITE][type] != counts[BLACK][type]) return counts[WHITE][type] > counts[BLACK][type];
+    }
+    return true;
+}
+
+Material Material::flipped() const {
+    Material material;
+    for (int type = KING; type <= PAWN; ++type) {
+        material.counts[WHITE][type] = counts[BLACK][type];
+        material.counts[BLACK][type] = counts[WHITE][type];
+    }
+    return material;
+}
+
+uint64_t Material::id() const {
+    uint64_t id = 0;
+    for (PieceColor color : { WHITE, BLACK }) {
+        for (int type = KING; type <= PAWN; ++type) id = (id << 4) | static_cast<uint64_t>(counts[color][type] & 15);
+    }
+    return id;
+}
+
+Layout::Layout(const Material& material) {
+    m_pieces[m_pieceCount++] = { KING, WHITE };
+    m_pieces[m_pieceCount++] = { KING, BLACK };
+    // Сначала фигуры обеих сторон, затем пешки.
+    for (bool pawns : { false, true }) {
+        for (PieceColor color : { WHITE, BLACK }) {
+            for (PieceType type : TypeOrder) {
+                if ((type == PAWN) != pawns) continue;
+                for (int i = 0; i < material.counts[color][type] && m_pieceCount < MaxPieces; ++i) {
+                    m_pieces[m_pieceCount++] = { type, color };
+                }
+            }
+        }
+    }
+    m_hasPawns = material.hasPawns();
+    m_size = static_cast<uint64_t>(g_kingPairCount[m_hasPawns]);
+    for (int i = 2; i < m_pieceCount; ++i) {
+        bool pawn = m_pieces[i].type == PAWN;
+        m_size *= pawn ? 48 : 64;
+        if (pawn) m_pawnSpace *= 48;
+    }
+}
+
+uint64_t Layout::encode(int squares[]) const {
+    int transform = 0;
+    while (!isCanonicalKing(transformSquare(squares[0], transform), m_hasPawns)) ++transform;
+    int transformed[MaxPieces];
+    uint64_t index = encodeTransformed(squares, transform, transformed);
+    // Король на диагонали a8-h1 остается в треугольнике и после транспонирования:
+    // из двух вариантов берется меньший индекс, чтобы у симметричных позиций он был один.
+    if (!m_hasPawns && squareRow(transformed[0]) == squareCol(transformed[0])) {
+        int transposed[MaxPieces];
+        uint64_t other = encodeTransformed(squares, transform ^ 4, transposed);
+        if (other < index) {
+            index = other;
+            std::copy(transposed, transposed + m_pieceCount, transformed);
+        }
+    }
+    std::copy(transformed, transformed + m_pieceCount, squares);
+    return index;
+}
+
+uint64_t Layout::encodeTransformed(const int squares[], int transform, int transformed[]) const {
+    for (int i = 0; i < m_pieceCount; ++i) transformed[i] = transformSquare(squares[i], transform);
+    for (int i = 3; i < m_pieceCount; ++i) {
+        for (int j = i; j > 2 && samePiece(m_pieces[j - 1], m_pieces[j]) && transformed[j - 1] > transformed[j]; --j) {
+            std::swap(transformed[j - 1], transformed[j]);
+        }
+    }
+
+    int pair = g_kingPairIndex[m_hasPawns][transformed[0]][transformed[1]];
+    if (pair < 0) return InvalidIndex;
+    uint64_t index = static_cast<uint64_t>(pair);
+    for (int i = 2; i < m_pieceCount; ++i) {
+        if (m_pieces[i].type == PAWN) {
+            int row = squareRow(transformed[i]);
+            if (row == 0 || row == 7) return InvalidIndex;
+            index = index * 48 + static_cast<uint64_t>(transformed[i] - 8);
+        } else {
+            index = index * 64 + static_cast<uint64_t>(transformed[i]);
+        }
+    }
+    return index;
+}
+
+uint64_t Layout::encode(const Position& position, bool flipColors) const {
+    int squares[MaxPieces];
+    for (int i = 0; i < m_pieceCount;) {
+        Piece piece = m_pieces[i];
+        Bitboard pieces = position.pieces(flipColors ? oppositeColor(piece.color) : piece.color, piece.type);
+        if (!pieces) return InvalidIndex;
+        while (pieces && i < m_pieceCount) {
+            int square = popLsb(pieces);
+            squares[i++] = flipColors ? square ^ 56 : square;
+        }
+    }
+    return encode(squares);
+}
+
+bool Layout::decode(uint64_t index, int squares[]) const {
+    if (index >= m_size) return false;
+    const uint64_t original = index;
+    for (int i = m_pieceCount - 1; i >= 2; --i) {
+        if (m_pieces[i].type == PAWN) {
+            squares[i] = static_cast<int>(index % 48) + 8;
+            index /= 48;
+        } else {
+            squares[i] = static_cast<int>(index % 64);
+            index /= 64;
+        }
+    }
+    squares[0] = g_kingPairSquares[m_hasPawns][index][0];
+    squares[1] = g_kingPairSquares[m_hasPawns][index][1];
+
+    Bitboard occupied = 0;
+    for (int i = 0; i < m_pieceCount; ++i) {
+        if (occupied & squareBB(squares[i])) return false;
+        occupied |= squareBB(squares[i]);
+        if (i > 2 && samePiece(m_pieces[i - 1], m_pieces[i]) && squares[i - 1] > squares[i]) return false;
+    }
+    if (!m_hasPawns && squareRow(squares[0]) == squareCol(squares[0])) {
+        int canonical[MaxPieces];
+        std::copy(squares, squares + m_pieceCount, canonical);
+        if (encode(canonical) != original) return false; // Тот же класс симметрии записан под меньшим индексом.
+    }
+    return true;
+}
+
+bool writeTable(const std::string& path, const Material& material,
+                const std::function<uint16_t(int side, uint64_t index)>& value, std::string* error) {
+    Layout layout(material);
+    int dtzBytes = 1;
+    for (int side = 0; side < 2 && dtzBytes == 1; ++side) {
+        for (uint64_t index = 0; index < layout.size(); ++index) {
+            if (streamValue(value(side, index), 1) > 0xFF) {
+                dtzBytes = 2;
+                break;
+            }
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return fail(error, "cannot create " + path);
+    unsigned char header[HeaderSize] = {};
+    std::memcpy(header, FileMagic, sizeof(FileMagic));
+    writeLittleEndian(header + 4, FileVersion, 4);
+    std::string name = material.name();
+    std::memcpy(header + 8, name.data(), std::min(name.size(), NameSize));
+    writeLittleEndian(header + 24, layout.size(), 8);
+    writeLittleEndian(header + 32, BlockSize, 4);
+    writeLittleEndian(header + 36, static_cast<unsigned long long>(dtzBytes), 4);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    uint64_t offset = HeaderSize;
+    for (int section = 0; section < 4; ++section) {
+        int stream = section % 2;
+        std::vector<unsigned char> bytes = compressSection(layout.size(), section / 2, stream,
+                                                           stream == 0 ? 1 : dtzBytes, value);
+        unsigned char sectionOffset[8];
+        writeLittleEndian(sectionOffset, offset, 8);
+        out.seekp(static_cast<std::streamoff>(40 + section * 8));
+        out.write(reinterpret_cast<const char*>(sectionOffset), sizeof(sectionOffset));
+        out.seekp(static_cast<std::streamoff>(offset));
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        offset += bytes.size();
+    }
+    out.close();
+    if (!out) return fail(error, "cannot write " + path);
+    return true;
+}
+
+int init(const std::string& directory) {
+    release();
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(directory, error)) {
+        if (entry.path().extension() != ".c9tb") continue;
+        Material material;
+        if (!Material::parse(entry.path().stem().string(), material) || !material.isCanonical()) continue;
+        std::unique_ptr<Table> table(new Table(material));
+        if (!loadTable(entry.path().string(), material, *table)) continue;
+        g_largest = std::max(g_largest, material.pieceCount());
+        g_tables[material.id()] = std::move(table);
+    }
+    return static_cast<int>(g_tables.size());
+}
+
+void release() {
+    g_tables.clear();
+    g_largest = 0;
+}
+
+int largestTable() {
+    return g_largest;
+}
+
+std::string loadedTables() {
+    std::vector<std::string> names;
+    for (const auto& table : g_tables) names.push_back(table.second->material.name());
+    std::sort(names.begin(), names.end());
+    std::string result;
+    for (const std::string& name : names) result += (result.empty() ? "" : " ") + name;
+    return result;
+}
+
+bool canProbe(const Position& position) {
+    return g_largest > 0 && position.castlingRights() == 0 && popCount(position.occupied()) <= g_largest;
+}
+
+bool probeWdl(const Position& position, Wdl& wdl) {
+    if (!canProbe(position)) return false;
+    if (position.enPassantSquare() >= 0) {
+        ProbeResult result;
+        if (!probeByMoves(position, result, nullptr)) return false;
+        wdl = result.wdl;
+        return true;
+    }
+    if (popCount(position.occupied()) == 2) {
+        wdl = WDL_DRAW;
+        return true;
+    }
+    int side;
+    uint64_t index;
+    const Table* table = findTable(position, side, index);
+    if (!table) return false;
+    wdl = static_cast<Wdl>(static_cast<int>(table->value(side, 0, index)) - 1);
+    return true;
+}
+
+bool probe(const Position& position, ProbeResult& result) {
+    if (!canProbe(position)) return false;
+    if (position.enPassantSquare() >= 0) return probeByMoves(position, result, nullptr);
+    result = ProbeResult();
+    if (popCount(position.occupied()) == 2) return true;
+    int side;
+    uint64_t index;
+    const Table* table = findTable(position, side, index);
+    if (!table) return false;
+    result.wdl = static_cast<Wdl>(static_cast<int>(table->value(side, 0, index)) - 1);
+    if (result.wdl != WDL_DRAW) result.dtz = static_cast<int>(table->value(side, 1, index));
+    return true;
+}
+
+PackedMove bestMove(const Position& position, ProbeResult* result) {
+    if (!canProbe(position)) return NullMove;
+    ProbeResult local;
+    PackedMove move = NullMove;
+    if (!probeByMoves(position, result ? *result : local, &move)) return NullMove;
+    return move;
+}
+
+} // namespace Tablebase
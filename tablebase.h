@@ -0,0 +1,124 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include "position.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/*
+ * Таблицы эндшпиля до пяти фигур (вместе с королями): для каждой позиции — исход
+ * при лучшей игре (WDL: выигрыш, ничья, проигрыш стороны, которой ходить) и DTZ —
+ * число полуходов до ближайшего «обнуляющего» хода (взятия или хода пешкой),
+ * с которым исход сохраняется. Правило 50 ходов таблицы не учитывают.
+ *
+ * Таблицы строит утилита chess960-tbgen ретроградным анализом (см. tbgen.cpp),
+ * по файлу на соотношение материала ("KQvKR.c9tb"). Движок и ChessGame обращаются
+ * к ним через отображение файлов в память: загрузка мгновенная, в память
+ * попадают только прочитанные блоки.
+ *
+ * Позиции с правом рокировки в таблицах не бывают (probe возвращает false);
+ * позиция с правом взятия на проходе оценивается через ходы из нее.
+ */
+namespace Tablebase {
+
+const int MaxPieces = 5;
+
+enum Wdl { WDL_LOSS = -1, WDL_DRAW = 0, WDL_WIN = 1 };  // Для стороны, которой ходить.
+
+struct ProbeResult {
+    Wdl wdl = WDL_DRAW;
+    int dtz = 0;            // Полуходов до обнуляющего хода (0 — мат или ничья).
+};
+
+// Соотношение материала: число фигур каждого типа у каждой стороны.
+struct Material {
+    int counts[3][7] = {};  // [PieceColor][PieceType]
+
+    static Material of(const Position& position);
+    // "KQvKR": белые, затем черные; фигуры в порядке Q, R, B, N, P.
+    static bool parse(const std::string& name, Material& material);
+    std::string name() const;
+    int pieceCount() const;
+    bool hasPawns() const;
+    // В таблице белые — сторона с большим материалом (при равенстве — любая).
+    bool isCanonical() const;
+    Material flipped() const;  // Цвета меняются местами.
+    uint64_t id() const;
+};
+
+/**
+ * @class Layout
+ * @brief Нумерация позиций одной таблицы.
+ *
+ * Фигуры идут в порядке: белый король, черный король, остальные белые, остальные
+ * черные (по типам Q, R, B, N), затем пешки белых и черных. Индекс — номер допустимой
+ * пары королей и клетки остальных фигур (у пешек — 48 клеток); пешки занимают младшие
+ * разряды, так что расстановка пешек — это index % pawnSpace(). Симметрия доски
+ * уменьшает таблицу: без пешек белый король переносится отражениями и поворотами
+ * в треугольник a8-d8-d5 (10 клеток), с пешками — только зеркально на вертикали a-d.
+ * Одинаковые фигуры упорядочиваются по клеткам. Индексы, которые не получаются из
+ * настоящей позиции или не минимальны в своем классе симметрии (наложение фигур,
+ * неупорядоченные одинаковые фигуры), при генерации помечаются недопустимыми.
+ */
+class Layout
+{
+public:
+    static const uint64_t InvalidIndex = ~uint64_t(0);
+
+    explicit Layout(const Material& material);
+
+    uint64_t size() const { return m_size; }     // Позиций на сторону.
+    int pieceCount() const { return m_pieceCount; }
+    Piece piece(int index) const { return m_pieces[index]; }
+    bool hasPawns() const { return m_hasPawns; }
+    uint64_t pawnSpace() const { return m_pawnSpace; }  // Число расстановок пешек (48^пешек).
+
+    // squares — клетки фигур в порядке piece(); массив приводится к каноническому виду.
+    uint64_t encode(int squares[]) const;
+    // Индекс позиции с материалом таблицы; flipColors — позиция с переставленными цветами
+    // (клетки отражаются по горизонтали доски, белые фигуры считаются черными).
+    uint64_t encode(const Position& position, bool flipColors = false) const;
+    // Обратно к клеткам; false — индекс не соответствует позиции (наложение фигур и т.п.).
+    bool decode(uint64_t index, int squares[]) const;
+
+private:
+    uint64_t encodeTransformed(const int squares[], int transform, int transformed[]) const;
+
+    Piece m_pieces[MaxPieces];
+    int m_pieceCount = 0;
+    bool m_hasPawns = false;
+    uint64_t m_pawnSpace = 1;
+    uint64_t m_size = 0;
+};
+
+// Коды значений при генерации и записи таблицы.
+const uint16_t ValueUnknown = 0;
+const uint16_t ValueDraw = 1;
+const uint16_t ValueIllegal = 2;
+const uint16_t LossBase = 0x4000;   // LossBase + dtz
+const uint16_t WinBase = 0x8000;    // WinBase + dtz
+
+// Записывает таблицу: value(side, index) возвращает код значения позиции
+// (side 0 — ходят белые, 1 — черные). Недопустимые позиции сжимаются вместе с соседними.
+bool writeTable(const std::string& path, const Material& material,
+                const std::function<uint16_t(int side, uint64_t index)>& value, std::string* error = nullptr);
+
+// Загружает все таблицы каталога (*.c9tb); возвращает число таблиц.
+int init(const std::string& directory);
+void release();
+int largestTable();                 // Наибольшее число фигур среди загруженных таблиц (0 — таблиц нет).
+std::string loadedTables();         // Имена загруженных таблиц через пробел.
+
+// Можно ли искать позицию в таблицах: фигур не больше largestTable и нет прав рокировки.
+bool canProbe(const Position& position);
+// Только исход (быстрее, для поиска).
+bool probeWdl(const Position& position, Wdl& wdl);
+bool probe(const Position& position, ProbeResult& result);
+// Лучший ход по таблицам: сохраняет исход; при выигрыше быстрее всего ведет к обнуляющему
+// ходу (мат — в первую очередь), при проигрыше — оттягивает его. NullMove — позиции нет в таблицах.
+PackedMove bestMove(const Position& position, ProbeResult* result = nullptr);
+
+} // namespace Tablebase
+
+#endif // TABLEBASE_H
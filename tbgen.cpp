@@ -0,0 +1,446 @@
+#include "movegen.h"
+#include "tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * chess960-tbgen — построение таблиц эндшпиля ретроградным анализом.
+ *
+ *   chess960-tbgen [-t THREADS] [-o DIR] --all N
+ *   chess960-tbgen [-t THREADS] [-o DIR] MATERIAL...      (например, KQvKR KRPvKR)
+ *   chess960-tbgen --probe DIR "<FEN>"
+ *
+ * --all N строит все таблицы до N фигур (3..5) в порядке, в котором каждой
+ * нужны только уже готовые: сначала меньше фигур, при равном числе — меньше пешек
+ * (превращение ведет в таблицу с меньшим числом пешек). Готовые файлы в DIR
+ * пропускаются, так что прерванную генерацию можно продолжить.
+ *
+ * Алгоритм. Ход, меняющий материал или двигающий пешку, — «обнуляющий»: его
+ * результат берется из уже готовых таблиц (для хода пешкой — из этой же таблицы,
+ * см. уровни ниже). Остальные ходы — внутренние. Начальный проход находит маты,
+ * паты, выигрыши обнуляющим ходом (выигрыш, DTZ 1) и позиции, где внутренних ходов нет;
+ * для прочих запоминает число различных внутренних ходов. Затем итерация n берет
+ * позиции с DTZ = n, и для каждой находит предшественников обратными ходами фигур
+ * (не пешек) стороны, сделавшей ход: за проигрышем следует выигрыш n + 1,
+ * а выигрыш уменьшает счетчик предшественника — обнулившийся счетчик значит,
+ * что все ходы ведут к выигрышу соперника, то есть проигрыш n + 1.
+ * Оставшиеся неизвестными позиции — ничьи.
+ *
+ * Уровни. Ход пешкой необратим и только увеличивает сумму продвижения пешек;
+ * поэтому таблица с пешками строится по уровням этой суммы от старшего к младшему,
+ * и ход пешкой всегда ведет на уже готовый уровень.
+ *
+ * Память: три байта на позицию на сторону (значение и счетчик). Самые большие
+ * пятифигурные таблицы с пешкой (KRPvKR и подобные) — около 360 млн позиций
+ * на сторону, ~2,2 ГБ; без пешек (KQRvKR) — ~150 млн, ~0,9 ГБ.
+ */
+
+namespace fs = std::filesystem;
+using namespace Tablebase;
+
+namespace {
+
+const PieceType MaterialTypes[] = { QUEEN, ROOK, BISHOP, KNIGHT, PAWN };
+const uint8_t DrawAvailable = 255;  // Счетчик позиции с ничейным обнуляющим ходом: проигрышем не станет.
+
+int codeToWdl(uint16_t code) {
+    if (code >= WinBase) return 1;
+    if (code >= LossBase) return -1;
+    return 0;
+}
+
+/**
+ * @class Generator
+ * @brief Построение одной таблицы: значения и счетчики обеих сторон в памяти,
+ *        обход позиций — порциями в нескольких потоках.
+ */
+class Generator
+{
+public:
+    Generator(const Material& material, int threads)
+        : m_material(material), m_layout(material), m_threads(threads),
+          m_values{ std::vector<std::atomic<uint16_t>>(m_layout.size()), std::vector<std::atomic<uint16_t>>(m_layout.size()) },
+          m_counters{ std::vector<std::atomic<uint8_t>>(m_layout.size()), std::vector<std::atomic<uint8_t>>(m_layout.size()) },
+          m_missing(false)
+    {
+        buildLevels();
+    }
+
+    bool run(std::string* error);
+    bool write(const std::string& path, std::string* error) const;
+    // Позиций по исходам для стороны side: выигрыш, ничья, проигрыш.
+    void count(int side, uint64_t counts[3]) const;
+
+private:
+    void buildLevels();
+    template <typename Function> void parallelFor(uint64_t count, Function function);
+    uint64_t levelIndex(const std::vector<uint64_t>& level, uint64_t item) const;
+
+    bool setup(uint64_t index, int side, Position& position) const;
+    int wdlOf(Position& position);
+    void initialize(uint64_t index, int side);
+    void propagate(uint64_t index, int side, uint16_t code, int distance);
+
+    Material m_material;
+    Layout m_layout;
+    int m_threads;
+    std::vector<std::atomic<uint16_t>> m_values[2];   // [сторона, которой ходить][индекс]
+    std::vector<std::atomic<uint8_t>> m_counters[2];  // Неразрешенные внутренние ходы.
+    std::vector<std::vector<uint64_t>> m_levels;      // Расстановки пешек по уровням, от старшего.
+    std::atomic<bool> m_missing;
+    std::string m_missingName;
+};
+
+void Generator::buildLevels() {
+    int pawnCount = 0;
+    for (int i = 0; i < m_layout.pieceCount(); ++i) pawnCount += m_layout.piece(i).type == PAWN;
+    m_levels.assign(static_cast<size_t>(pawnCount * 5 + 1), {});
+    for (uint64_t pawns = 0; pawns < m_layout.pawnSpace(); ++pawns) {
+        // Индекс < pawnSpace — первая пара королей: клетки пешек разбираются так же.
+        int squares[MaxPieces];
+        m_layout.decode(pawns, squares);
+        int level = 0;
+        for (int i = 0; i < m_layout.pieceCount(); ++i) {
+            Piece piece = m_layout.piece(i);
+            if (piece.type != PAWN) continue;
+            level += piece.color == WHITE ? 6 - squareRow(squares[i]) : squareRow(squares[i]) - 1;
+        }
+        m_levels[m_levels.size() - 1 - static_cast<size_t>(level)].push_back(pawns);
+    }
+}
+
+template <typename Function>
+void Generator::parallelFor(uint64_t count, Function function) {
+    const uint64_t ChunkSize = 4096;
+    std::atomic<uint64_t> next(0);
+    auto worker = [&]() {
+        for (;;) {
+            uint64_t begin = next.fetch_add(ChunkSize);
+            if (begin >= count) return;
+            uint64_t end = std::min(count, begin + ChunkSize);
+            for (uint64_t item = begin; item < end; ++item) function(item);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < m_threads; ++i) threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads) thread.join();
+}
+
+uint64_t Generator::levelIndex(const std::vector<uint64_t>& level, uint64_t item) const {
+    return (item / level.size()) * m_layout.pawnSpace() + level[item % level.size()];
+}
+
+bool Generator::setup(uint64_t index, int side, Position& position) const {
+    int squares[MaxPieces];
+    if (!m_layout.decode(index, squares)) return false;
+    position.clear();
+    for (int i = 0; i < m_layout.pieceCount(); ++i) position.putPiece(squares[i], m_layout.piece(i));
+    position.setSideToMove(side == 0 ? WHITE : BLACK);
+    position.updateAttackInfo();
+    // Король стороны, которая не ходит, под шахом — такой позиции не бывает.
+    return !position.isKingInCheck(side == 0 ? BLACK : WHITE);
+}
+
+// Исход для стороны, которой ходить, в позиции после обнуляющего хода.
+int Generator::wdlOf(Position& position) {
+    if (position.enPassantSquare() >= 0) {
+        // Право взятия на проходе: позиции нет в таблицах, оцениваем ходы из нее.
+        MoveList moves;
+        generateLegalMoves(position, moves);
+        if (moves.size == 0) return position.checkers() ? -1 : 0;
+        int best = -1;
+        for (PackedMove move : moves) {
+            UndoInfo undo;
+            position.makeMove(move, undo);
+            best = std::max(best, -wdlOf(position));
+            position.unmakeMove(move, undo);
+        }
+        return best;
+    }
+    Material material = Material::of(position);
+    if (material.id() == m_material.id()) {
+        // Ход пешкой: старший уровень этой таблицы уже готов.
+        int side = position.sideToMove() == WHITE ? 0 : 1;
+        return codeToWdl(m_values[side][m_layout.encode(position)].load(std::memory_order_relaxed));
+    }
+    if (material.pieceCount() == 2) return 0;
+    Wdl wdl;
+    if (probeWdl(position, wdl)) return wdl;
+    if (!m_missing.exchange(true)) {
+        m_missingName = (material.isCanonical() ? material : material.flipped()).name();
+    }
+    return 0;
+}
+
+void Generator::initialize(uint64_t index, int side) {
+    std::atomic<uint16_t>& value = m_values[side][index];
+    Position position;
+    if (!setup(index, side, position)) {
+        value.store(ValueIllegal, std::memory_order_relaxed);
+        return;
+    }
+    MoveList moves;
+    generateLegalMoves(position, moves);
+    if (moves.size == 0) {
+        value.store(position.checkers() ? LossBase : ValueDraw, std::memory_order_relaxed);
+        return;
+    }
+
+    int bestConversion = -2;  // Лучший исход обнуляющего хода (-2 — таких ходов нет).
+    uint64_t children[256];
+    int childCount = 0;
+    for (PackedMove move : moves) {
+        UndoInfo undo;
+        position.makeMove(move, undo);
+        if (undo.captured.type != NONE || undo.moved.type == PAWN) {
+            bestConversion = std::max(bestConversion, -wdlOf(position));
+        } else {
+            uint64_t child = m_layout.encode(position);
+            if (std::find(children, children + childCount, child) == children + childCount) children[childCount++] = child;
+        }
+        position.unmakeMove(move, undo);
+        if (bestConversion == 1) break;
+    }
+
+    if (bestConversion == 1) {
+        value.store(WinBase + 1, std::memory_order_relaxed);
+    } else if (childCount == 0) {
+        value.store(bestConversion == 0 ? ValueDraw : LossBase + 1, std::memory_order_relaxed);
+    } else {
+        m_counters[side][index].store(bestConversion == 0 ? DrawAvailable : static_cast<uint8_t>(childCount),
+                                      std::memory_order_relaxed);
+    }
+}
+
+// Позиция index (ходит side) получила DTZ distance: уточняем ее предшественников.
+void Generator::propagate(uint64_t index, int side, uint16_t code, int distance) {
+    int squares[MaxPieces];
+    m_layout.decode(index, squares);
+    Bitboard occupied = 0;
+    for (int i = 0; i < m_layout.pieceCount(); ++i) occupied |= squareBB(squares[i]);
+
+    int mover = 1 - side;
+    PieceColor moverColor = mover == 0 ? WHITE : BLACK;
+    bool lost = code < WinBase;
+    uint64_t seen[256];
+    int seenCount = 0;
+    for (int i = 0; i < m_layout.pieceCount(); ++i) {
+        Piece piece = m_layout.piece(i);
+        if (piece.color != moverColor || piece.type == PAWN) continue;
+        // Ходы фигур обратимы: фигура могла прийти с любой клетки, которую бьет отсюда.
+        Bitboard origins = Position::attacksFrom(piece, squares[i], occupied) & ~occupied;
+        while (origins) {
+            int previous[MaxPieces];
+            std::copy(squares, squares + m_layout.pieceCount(), previous);
+            previous[i] = popLsb(origins);
+            uint64_t predecessor = m_layout.encode(previous);
+            if (predecessor == Layout::InvalidIndex) continue;
+            if (std::find(seen, seen + seenCount, predecessor) != seen + seenCount) continue;
+            seen[seenCount++] = predecessor;
+
+            std::atomic<uint16_t>& value = m_values[mover][predecessor];
+            if (value.load(std::memory_order_relaxed) != ValueUnknown) continue;
+            uint16_t expected = ValueUnknown;
+            if (lost) {
+                value.compare_exchange_strong(expected, static_cast<uint16_t>(WinBase + distance + 1));
+            } else {
+                std::atomic<uint8_t>& counter = m_counters[mover][predecessor];
+                if (counter.load(std::memory_order_relaxed) == DrawAvailable) continue;
+                if (counter.fetch_sub(1) == 1) value.compare_exchange_strong(expected, static_cast<uint16_t>(LossBase + distance + 1));
+            }
+        }
+    }
+}
+
+bool Generator::run(std::string* error) {
+    for (const std::vector<uint64_t>& level : m_levels) {
+        if (level.empty()) continue;
+        uint64_t items = m_layout.size() / m_layout.pawnSpace() * level.size();
+        parallelFor(items * 2, [&](uint64_t item) { initialize(levelIndex(level, item / 2), static_cast<int>(item % 2)); });
+        if (m_missing) {
+            if (error) *error = "missing table " + m_missingName;
+            return false;
+        }
+
+        for (int distance = 0; ; ++distance) {
+            std::atomic<uint64_t> frontier(0);
+            parallelFor(items * 2, [&](uint64_t item) {
+                uint64_t index = levelIndex(level, item / 2);
+                int side = static_cast<int>(item % 2);
+                uint16_t code = m_values[side][index].load(std::memory_order_relaxed);
+                if (code == LossBase + distance || code == WinBase + distance) {
+                    frontier.fetch_add(1, std::memory_order_relaxed);
+                    propagate(index, side, code, distance);
+                }
+            });
+            if (distance > 0 && frontier == 0) break;
+        }
+
+        parallelFor(items * 2, [&](uint64_t item) {
+            uint16_t expected = ValueUnknown;
+            m_values[item % 2][levelIndex(level, item / 2)].compare_exchange_strong(expected, ValueDraw);
+        });
+    }
+    return true;
+}
+
+bool Generator::write(const std::string& path, std::string* error) const {
+    return writeTable(path, m_material, [this](int side, uint64_t index) {
+        return m_values[side][index].load(std::memory_order_relaxed);
+    }, error);
+}
+
+void Generator::count(int side, uint64_t counts[3]) const {
+    counts[0] = counts[1] = counts[2] = 0;
+    for (const std::atomic<uint16_t>& value : m_values[side]) {
+        uint16_t code = value.load(std::memory_order_relaxed);
+        if (code != ValueIllegal) ++counts[1 - codeToWdl(code)];
+    }
+}
+
+// Все канонические соотношения материала от 3 до maxPieces фигур в порядке построения.
+std::vector<Material> allMaterials(int maxPieces) {
+    std::vector<Material> materials;
+    const int Slots = 10;  // Пять типов у каждой стороны.
+    int counts[Slots] = {};
+    for (;;) {
+        Material material;
+        material.counts[WHITE][KING] = material.counts[BLACK][KING] = 1;
+        for (int slot = 0; slot < Slots; ++slot) {
+            material.counts[slot < 5 ? WHITE : BLACK][MaterialTypes[slot % 5]] = counts[slot];
+        }
+        int pieces = material.pieceCount();
+        if (pieces >= 3 && pieces <= maxPieces && material.isCanonical()) materials.push_back(material);
+
+        int slot = 0;
+        while (slot < Slots && ++counts[slot] > maxPieces - 2) counts[slot++] = 0;
+        if (slot == Slots) break;
+    }
+    std::stable_sort(materials.begin(), materials.end(), [](const Material& a, const Material& b) {
+        int pawnsA = a.counts[WHITE][PAWN] + a.counts[BLACK][PAWN];
+        int pawnsB = b.counts[WHITE][PAWN] + b.counts[BLACK][PAWN];
+        if (a.pieceCount() != b.pieceCount()) return a.pieceCount() < b.pieceCount();
+        if (pawnsA != pawnsB) return pawnsA < pawnsB;
+        return a.name() < b.name();
+    });
+    return materials;
+}
+
+bool generate(const Material& material, const std::string& directory, int threads) {
+    std::string path = (fs::path(directory) / (material.name() + ".c9tb")).string();
+    if (fs::exists(path)) {
+        std::printf("%-10s exists\n", material.name().c_str());
+        return true;
+    }
+    auto start = std::chrono::steady_clock::now();
+    Generator generator(material, threads);
+    std::string error;
+    if (!generator.run(&error) || !generator.write(path, &error)) {
+        std::fprintf(stderr, "%s: %s\n", material.name().c_str(), error.c_str());
+        return false;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t white[3], black[3];
+    generator.count(0, white);
+    generator.count(1, black);
+    std::printf("%-10s %12llu positions  white to move %llu/%llu/%llu  black to move %llu/%llu/%llu  %.1f s  %llu bytes\n",
+                material.name().c_str(), static_cast<unsigned long long>(Layout(material).size()),
+                static_cast<unsigned long long>(white[0]), static_cast<unsigned long long>(white[1]),
+                static_cast<unsigned long long>(white[2]), static_cast<unsigned long long>(black[0]),
+                static_cast<unsigned long long>(black[1]), static_cast<unsigned long long>(black[2]),
+                seconds, static_cast<unsigned long long>(fs::file_size(path)));
+    std::fflush(stdout);
+    // Следующим таблицам нужна и эта.
+    init(directory);
+    return true;
+}
+
+int runProbe(const std::string& directory, const std::string& fen) {
+    Position position;
+    if (!position.setFromFen(fen)) {
+        std::fprintf(stderr, "Invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+    init(directory);
+    ProbeResult result;
+    if (!probe(position, result)) {
+        std::fprintf(stderr, "Position is not in the tablebases (%s)\n", loadedTables().c_str());
+        return 1;
+    }
+    const char* names[] = { "loss", "draw", "win" };
+    std::printf("%s  DTZ %d\n", names[result.wdl + 1], result.dtz);
+
+    // Лучшая линия до мата, ничьей или 200 полуходов.
+    std::string line;
+    for (int ply = 0; ply < 200; ++ply) {
+        PackedMove move = bestMove(position);
+        if (move == NullMove) break;
+        line += (line.empty() ? "" : " ") + moveToString(move);
+        UndoInfo undo;
+        position.makeMove(move, undo);
+        if (!probe(position, result) || result.wdl == WDL_DRAW) break;
+    }
+    if (!line.empty()) std::printf("line: %s\n", line.c_str());
+    return 0;
+}
+
+void printUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [-t THREADS] [-o DIR] --all N | MATERIAL...\n"
+                         "       %s --probe DIR FEN\n", program, program);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string directory = ".", probeDirectory, fen;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int all = 0;
+    std::vector<Material> materials;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        Material material;
+        if (arg == "-t" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "-o" && hasValue) directory = argv[++i];
+        else if (arg == "--all" && hasValue) all = std::atoi(argv[++i]);
+        else if (arg == "--probe" && i + 2 < argc) { probeDirectory = argv[++i]; fen = argv[++i]; }
+        else if (Material::parse(arg, material) && material.pieceCount() >= 3) {
+            materials.push_back(material.isCanonical() ? material : material.flipped());
+        } else { printUsage(argv[0]); return 2; }
+    }
+
+    if (!probeDirectory.empty()) return runProbe(probeDirectory, fen);
+    if (all) {
+        if (all < 3 || all > MaxPieces) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        materials = allMaterials(all);
+    }
+    if (materials.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::error_code error;
+    fs::create_directories(directory, error);
+    init(directory);
+    auto start = std::chrono::steady_clock::now();
+    for (const Material& material : materials) {
+        if (!generate(material, directory, threads)) return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu tables in %.1f s, %d threads\n", materials.size(), seconds, threads);
+    return 0;
+}
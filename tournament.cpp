@@ -0,0 +1,341 @@
+#include "chess_game.h"
+#include "search.h"
+#include "startpos.h"
+#include "tablebase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * chess960-tournament — матч движка с самим собой в несколько потоков: по партии на поток.
+ *
+ *   chess960-tournament [-g GAMES] [-j THREADS] [--a SPEC] [--b SPEC] [--hash MB]
+ *                       [--start SP] [--max-plies N] [--tb DIR] [--sprt ELO0,ELO1] [-o FILE.pgn]
+ *
+ * SPEC — лимиты поиска игрока через запятую: "nodes=20000", "depth=6", "movetime=50"
+ * (по умолчанию nodes=20000 у обоих). Партии идут парами: в паре одна и та же
+ * стартовая позиция (SP, SP+1, ... по кругу из 960), A играет белыми, затем черными.
+ * Исход определяет ChessGame::updateGameStatus (мат, пат, повторение, 50 ходов,
+ * недостаточный материал; с --tb — и таблицы эндшпиля); партия длиннее --max-plies
+ * полуходов (по умолчанию 600) признается ничьей.
+ *
+ * Партии дописываются в PGN по мере окончания — в записи history/ ("e2-e4", рокировка —
+ * "король берет ладью") с тегами Variant "Chess960", SetUp и FEN.
+ *
+ * Итог: счет A против B, разница Эло с 95% доверительным интервалом и SPRT
+ * (логарифм отношения правдоподобия для гипотез ELO0 и ELO1, ошибки 5%).
+ * С --sprt матч заканчивается, как только тест принял одну из гипотез.
+ * Метрика скорости — партий в час на всех потоках.
+ */
+
+namespace {
+
+const int DefaultGames = 200;
+const int DefaultHashMb = 8;
+const int DefaultMaxPlies = 600;
+const uint64_t DefaultNodes = 20000;
+const double SprtAlpha = 0.05;
+const double SprtBeta = 0.05;
+
+struct EngineSpec {
+    std::string text;
+    SearchLimits limits;
+};
+
+bool parseSpec(const std::string& text, EngineSpec& spec) {
+    spec.text = text;
+    spec.limits = SearchLimits();
+    std::istringstream input(text);
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) return false;
+        std::string key = item.substr(0, equals);
+        long long value = std::atoll(item.c_str() + equals + 1);
+        if (value <= 0) return false;
+        if (key == "nodes") spec.limits.nodes = static_cast<uint64_t>(value);
+        else if (key == "depth") spec.limits.depth = static_cast<int>(value);
+        else if (key == "movetime") spec.limits.moveTimeMs = static_cast<int>(value);
+        else return false;
+    }
+    return true;
+}
+
+// Счет с точки зрения игрока A.
+struct Score {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double mean() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+    // Дисперсия очков одной партии. К счету добавляется по половине партии каждого исхода
+    // (априорное распределение): при одинаковых исходах выборочная дисперсия равна нулю,
+    // интервал Эло схлопывается в точку, а SPRT не может остановиться.
+    double variance() const {
+        const double prior = 0.5;
+        double w = wins + prior, d = draws + prior, l = losses + prior, n = w + d + l;
+        double m = (w + 0.5 * d) / n;
+        return (w * (1 - m) * (1 - m) + d * (0.5 - m) * (0.5 - m) + l * m * m) / n;
+    }
+};
+
+double eloFromScore(double score) {
+    score = std::clamp(score, 1e-6, 1 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double scoreFromElo(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Логарифм отношения правдоподобия H1 (elo1) к H0 (elo0) в нормальном приближении.
+double sprtLlr(const Score& score, double elo0, double elo1) {
+    double variance = score.variance();
+    if (score.games() < 2) return 0;
+    double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+    return score.games() * (s1 - s0) * (2 * score.mean() - s0 - s1) / (2 * variance);
+}
+
+struct GameResult {
+    double pointsA = 0.5;
+    std::string pgn;
+};
+
+/**
+ * @class Tournament
+ * @brief Пул потоков, разбирающих партии по номерам; общий счет, PGN и SPRT.
+ */
+class Tournament
+{
+public:
+    Tournament(const EngineSpec& a, const EngineSpec& b, int games, int threads)
+        : m_specs{ a, b }, m_games(games), m_threads(threads), m_next(0), m_stop(false) {}
+
+    int hashMb = DefaultHashMb;
+    int startSp = 0;
+    int maxPlies = DefaultMaxPlies;
+    bool useTablebases = false;
+    bool sprt = false;
+    double elo0 = 0, elo1 = 5;
+    std::string pgnPath;
+
+    bool run();
+
+private:
+    void worker();
+    GameResult playGame(int number, Search engines[2]);
+    void record(const GameResult& result);
+    void printStatus(bool final);
+
+    EngineSpec m_specs[2];
+    int m_games;
+    int m_threads;
+    std::atomic<int> m_next;
+    std::atomic<bool> m_stop;
+    std::mutex m_mutex;               // Счет, файл PGN и вывод.
+    Score m_score;
+    std::ofstream m_pgn;
+    std::chrono::steady_clock::time_point m_start;
+    std::string m_date;               // Тег Date всех партий: localtime не потокобезопасна.
+};
+
+bool Tournament::run() {
+    if (!pgnPath.empty()) {
+        m_pgn.open(pgnPath, std::ios::trunc);
+        if (!m_pgn) {
+            std::fprintf(stderr, "cannot create %s\n", pgnPath.c_str());
+            return false;
+        }
+    }
+    m_start = std::chrono::steady_clock::now();
+    char date[16];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&now));
+    m_date = date;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < m_threads; ++i) threads.emplace_back([this]() { worker(); });
+    for (std::thread& thread : threads) thread.join();
+    printStatus(true);
+    return true;
+}
+
+void Tournament::worker() {
+    // У каждого потока свои движки: поиск однопоточный, таблица перестановок своя.
+    Search engines[2];
+    for (Search& engine : engines) {
+        engine.setThreads(1);
+        engine.setHashSizeMb(static_cast<size_t>(hashMb));
+    }
+    for (;;) {
+        int number = m_next.fetch_add(1);
+        if (number >= m_games || m_stop) return;
+        for (Search& engine : engines) engine.transpositionTable().clear();
+        record(playGame(number, engines));
+    }
+}
+
+GameResult Tournament::playGame(int number, Search engines[2]) {
+    int spIndex = (startSp + number / 2) % Chess960PositionCount;
+    int whiteEngine = number % 2;  // В паре A играет сначала белыми, потом черными.
+
+    ChessGame game;
+    game.setTablebaseAdjudication(useTablebases);
+    game.setupNewGame(spIndex);
+    std::string startFen = game.position().fen();
+
+    std::string moves;
+    int ply = 0;
+    while (game.getGameStatus() == IN_PROGRESS && ply < maxPlies) {
+        int side = game.getCurrentTurn() == WHITE ? whiteEngine : 1 - whiteEngine;
+        SearchResult result = engines[side].think(game.position(), m_specs[side].limits, game.keyHistory());
+        Move move = unpackMove(result.bestMove);
+        if (result.bestMove == NullMove || !game.tryMove(move)) break;
+
+        if (ply % 2 == 0) moves += std::to_string(ply / 2 + 1) + ". ";
+        moves += std::string(1, static_cast<char>('a' + move.fromCol)) + std::to_string(8 - move.fromRow) + "-"
+                 + static_cast<char>('a' + move.toCol) + std::to_string(8 - move.toRow);
+        if (move.promotion != NONE) moves += std::string("=") + " KQRBNP"[move.promotion];
+        moves += ' ';
+        ++ply;
+    }
+
+    GameStatus status = game.getGameStatus();
+    PieceColor winner = game.getWinner();
+    std::string result = winner == WHITE ? "1-0" : winner == BLACK ? "0-1" : "1/2-1/2";
+    const char* termination = status == CHECKMATE ? "checkmate"
+                            : status == TABLEBASE_WIN || status == TABLEBASE_DRAW ? "tablebase adjudication"
+                            : status == IN_PROGRESS ? "max plies adjudication" : "draw";
+
+    GameResult outcome;
+    PieceColor colorA = whiteEngine == 0 ? WHITE : BLACK;
+    outcome.pointsA = winner == NO_COLOR ? 0.5 : winner == colorA ? 1.0 : 0.0;
+
+    std::string names[2] = { "Chess960 A (" + m_specs[0].text + ")", "Chess960 B (" + m_specs[1].text + ")" };
+    std::ostringstream pgn;
+    pgn << "[Event \"Chess960 Tournament\"]\n"
+        << "[Site \"Local\"]\n"
+        << "[Date \"" << m_date << "\"]\n"
+        << "[Round \"" << number + 1 << "\"]\n"
+        << "[White \"" << names[whiteEngine] << "\"]\n"
+        << "[Black \"" << names[1 - whiteEngine] << "\"]\n"
+        << "[Result \"" << result << "\"]\n"
+        << "[Variant \"Chess960\"]\n"
+        << "[SetUp \"1\"]\n"
+        << "[FEN \"" << startFen << "\"]\n"
+        << "[StartPosition \"" << spIndex << "\"]\n"
+        << "[PlyCount \"" << ply << "\"]\n"
+        << "[Termination \"" << termination << "\"]\n\n"
+        << moves << result << "\n\n";
+    outcome.pgn = pgn.str();
+    return outcome;
+}
+
+void Tournament::record(const GameResult& result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (result.pointsA == 1.0) ++m_score.wins;
+    else if (result.pointsA == 0.0) ++m_score.losses;
+    else ++m_score.draws;
+    if (m_pgn) {
+        m_pgn << result.pgn;
+        m_pgn.flush();
+    }
+
+    if (sprt) {
+        double llr = sprtLlr(m_score, elo0, elo1);
+        if (llr <= std::log(SprtBeta / (1 - SprtAlpha)) || llr >= std::log((1 - SprtBeta) / SprtAlpha)) m_stop = true;
+    }
+    // Промежуточный счет — после каждой пары партий.
+    if (m_score.games() % 2 == 0 || m_stop) printStatus(false);
+}
+
+void Tournament::printStatus(bool final) {
+    if (final) m_mutex.lock();
+    int games = m_score.games();
+    double mean = m_score.mean();
+    double margin = games > 1 ? 1.96 * std::sqrt(m_score.variance() / games) : 0.5;
+    double elo = eloFromScore(mean);
+    double eloLow = eloFromScore(mean - margin), eloHigh = eloFromScore(mean + margin);
+    double hours = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count() / 3600;
+    double llr = sprtLlr(m_score, elo0, elo1);
+    double lower = std::log(SprtBeta / (1 - SprtAlpha)), upper = std::log((1 - SprtBeta) / SprtAlpha);
+
+    std::printf("%s %d/%d  A +%d =%d -%d  Elo %+.1f [%+.1f, %+.1f]  LLR %.2f [%.2f, %.2f]%s  %.0f games/h\n",
+                final ? "Final" : "Games", games, m_games, m_score.wins, m_score.draws, m_score.losses,
+                elo, eloLow, eloHigh, llr, lower, upper,
+                llr >= upper ? " H1 accepted" : llr <= lower ? " H0 accepted" : "",
+                hours > 0 ? games / hours : 0.0);
+    std::fflush(stdout);
+    if (final) m_mutex.unlock();
+}
+
+void printUsage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [-g GAMES] [-j THREADS] [--a SPEC] [--b SPEC] [--hash MB] [--start SP]\n"
+                         "          [--max-plies N] [--tb DIR] [--sprt ELO0,ELO1] [-o FILE.pgn]\n"
+                         "SPEC: nodes=N,depth=N,movetime=MS (default nodes=%llu)\n",
+                 program, static_cast<unsigned long long>(DefaultNodes));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string defaultSpec = "nodes=" + std::to_string(DefaultNodes);
+    EngineSpec specs[2];
+    parseSpec(defaultSpec, specs[0]);
+    parseSpec(defaultSpec, specs[1]);
+    int games = DefaultGames;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int hashMb = DefaultHashMb, startSp = 0, maxPlies = DefaultMaxPlies;
+    std::string pgnPath, tablebasePath;
+    bool sprt = false;
+    double elo0 = 0, elo1 = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-g" && hasValue) games = std::atoi(argv[++i]);
+        else if (arg == "-j" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--a" && hasValue && parseSpec(argv[i + 1], specs[0])) ++i;
+        else if (arg == "--b" && hasValue && parseSpec(argv[i + 1], specs[1])) ++i;
+        else if (arg == "--hash" && hasValue) hashMb = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--start" && hasValue) startSp = std::atoi(argv[++i]);
+        else if (arg == "--max-plies" && hasValue) maxPlies = std::atoi(argv[++i]);
+        else if (arg == "--tb" && hasValue) tablebasePath = argv[++i];
+        else if (arg == "--sprt" && hasValue && std::sscanf(argv[i + 1], "%lf,%lf", &elo0, &elo1) == 2) { sprt = true; ++i; }
+        else if (arg == "-o" && hasValue) pgnPath = argv[++i];
+        else { printUsage(argv[0]); return 2; }
+    }
+    if (games < 1 || maxPlies < 1 || startSp < 0 || startSp >= Chess960PositionCount || elo1 <= elo0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (!tablebasePath.empty() && Tablebase::init(tablebasePath) == 0) {
+        std::fprintf(stderr, "No tablebases in %s\n", tablebasePath.c_str());
+        return 2;
+    }
+
+    std::printf("A: %s  B: %s  games %d  threads %d  hash %d MB\n",
+                specs[0].text.c_str(), specs[1].text.c_str(), games, threads, hashMb);
+    Tournament tournament(specs[0], specs[1], games, std::min(threads, games));
+    tournament.hashMb = hashMb;
+    tournament.startSp = startSp;
+    tournament.maxPlies = maxPlies;
+    tournament.useTablebases = !tablebasePath.empty();
+    tournament.sprt = sprt;
+    tournament.elo0 = elo0;
+    tournament.elo1 = elo1;
+    tournament.pgnPath = pgnPath;
+    return tournament.run() ? 0 : 1;
+}
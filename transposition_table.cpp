@@ -0,0 +1,116 @@
+#include "transposition_table.h"
+
+namespace {
+
+// Упаковка записи в 64 бита:
+// 0-15 ход, 16-31 оценка (int16), 32-39 глубина, 40-41 граница, 48-55 поколение.
+uint64_t packData(PackedMove move, int score, int depth, TTBound bound, uint8_t generation) {
+    return uint64_t(move)
+         | uint64_t(uint16_t(int16_t(score))) << 16
+         | uint64_t(uint8_t(depth)) << 32
+         | uint64_t(bound) << 40
+         | uint64_t(generation) << 48;
+}
+
+PackedMove dataMove(uint64_t data) { return PackedMove(data & 0xFFFF); }
+int dataScore(uint64_t data) { return int16_t(uint16_t(data >> 16)); }
+int dataDepth(uint64_t data) { return uint8_t(data >> 32); }
+TTBound dataBound(uint64_t data) { return TTBound((data >> 40) & 3); }
+uint8_t dataGeneration(uint64_t data) { return uint8_t(data >> 48); }
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t sizeMb) : m_bucketCount(0), m_generation(0), m_probes(0), m_hits(0) {
+    resize(sizeMb);
+}
+
+void TranspositionTable::resize(size_t sizeMb) {
+    size_t maxBuckets = sizeMb * 1024 * 1024 / sizeof(Bucket);
+    size_t count = 1;
+    while (count * 2 <= maxBuckets) count *= 2;
+    if (count != m_bucketCount) {
+        m_buckets.reset();
+        m_buckets.reset(new Bucket[count]);
+        m_bucketCount = count;
+    }
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < m_bucketCount; ++i) {
+        for (Slot& slot : m_buckets[i].slots) {
+            slot.keyXorData.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    m_generation = 0;
+    resetStats();
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Bucket& bucket = bucketFor(key);
+    for (const Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) != key || data == 0) continue;
+        entry.move = dataMove(data);
+        entry.score = dataScore(data);
+        entry.depth = dataDepth(data);
+        entry.bound = dataBound(data);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, TTBound bound, int score, PackedMove move) {
+    Bucket& bucket = bucketFor(key);
+
+    // Своя запись обновляется на месте, иначе вытесняется наименее ценная:
+    // пустая, затем самая старая и мелкая.
+    Slot* replace = nullptr;
+    int replaceValue = 0;
+    for (Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) == key) {
+            // Запись без хода не стирает известный лучший ход, а мелкий поиск
+            // не затирает более глубокий результат (кроме точной оценки).
+            if (move == NullMove) move = dataMove(data);
+            if (bound != BOUND_EXACT && depth < dataDepth(data) - 2 && dataGeneration(data) == m_generation) return;
+            replace = &slot;
+            break;
+        }
+        int age = uint8_t(m_generation - dataGeneration(data));
+        int value = data == 0 ? -1000 : dataDepth(data) - 8 * age;
+        if (!replace || value < replaceValue) {
+            replace = &slot;
+            replaceValue = value;
+        }
+    }
+
+    uint64_t data = packData(move, score, depth, bound, m_generation);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    const int sample = 1000;
+    int used = 0;
+    int counted = 0;
+    for (size_t i = 0; i < m_bucketCount && counted < sample; ++i) {
+        for (const Slot& slot : m_buckets[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && dataGeneration(data) == m_generation) ++used;
+            ++counted;
+        }
+    }
+    return counted ? used * 1000 / counted : 0;
+}
+
+void TranspositionTable::addProbeStats(uint64_t probes, uint64_t hits) {
+    m_probes.fetch_add(probes, std::memory_order_relaxed);
+    m_hits.fetch_add(hits, std::memory_order_relaxed);
+}
+
+void TranspositionTable::resetStats() {
+    m_probes = 0;
+    m_hits = 0;
+}
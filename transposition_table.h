@@ -0,0 +1,81 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "chess_types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Какую границу оценки хранит запись: точное значение, не выше (Upper) или не ниже (Lower).
+enum TTBound : uint8_t { BOUND_NONE = 0, BOUND_UPPER = 1, BOUND_LOWER = 2, BOUND_EXACT = 3 };
+
+// Распакованное содержимое записи.
+struct TTEntry {
+    PackedMove move = NullMove;
+    int score = 0;
+    int depth = 0;
+    TTBound bound = BOUND_NONE;
+};
+
+/**
+ * @class TranspositionTable
+ * @brief Таблица перестановок: кеш результатов поиска по хешу Зобриста позиции.
+ *
+ * Записи сгруппированы в корзины по 64 байта (одна кеш-линия), корзина выбирается
+ * младшими битами хеша. Запись — два 64-битных слова: упакованные данные и хеш,
+ * сложенный с ними по XOR. Блокировок нет: потоки поиска пишут и читают таблицу
+ * одновременно, а запись, разорванную параллельной записью, отбрасывает проверка
+ * (keyXorData ^ data != key).
+ *
+ * Размер задается в мегабайтах и округляется вниз до степени двойки корзин.
+ * Счетчики попаданий накапливает вызывающий (addProbeStats), чтобы поиск
+ * не писал в общую память на каждом обращении.
+ */
+class TranspositionTable
+{
+public:
+    static const size_t DefaultSizeMb = 16;
+
+    explicit TranspositionTable(size_t sizeMb = DefaultSizeMb);
+
+    void resize(size_t sizeMb);             // Перевыделяет таблицу; содержимое теряется.
+    void clear();                           // Очищает записи и счетчики.
+    void newSearch() { ++m_generation; }    // Начало нового поиска: старые записи вытесняются охотнее.
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, int depth, TTBound bound, int score, PackedMove move);
+
+    size_t sizeMb() const { return m_bucketCount * sizeof(Bucket) / (1024 * 1024); }
+    // Заполненность записями текущего поиска в промилле (по выборке первых 1000 записей).
+    int hashfull() const;
+
+    // Статистика обращений: probes — всего, hits — найдена запись с этим хешем.
+    void addProbeStats(uint64_t probes, uint64_t hits);
+    void resetStats();
+    uint64_t probes() const { return m_probes; }
+    uint64_t hits() const { return m_hits; }
+    double hitRate() const { return m_probes ? double(m_hits) / m_probes : 0.0; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+
+    static const int SlotsPerBucket = 4;
+
+    struct alignas(64) Bucket {
+        Slot slots[SlotsPerBucket];
+    };
+
+    Bucket& bucketFor(uint64_t key) const { return m_buckets[key & (m_bucketCount - 1)]; }
+
+    std::unique_ptr<Bucket[]> m_buckets;
+    size_t m_bucketCount;
+    uint8_t m_generation;
+    std::atomic<uint64_t> m_probes;
+    std::atomic<uint64_t> m_hits;
+};
+
+#endif // TRANSPOSITION_TABLE_H
@@ -0,0 +1,317 @@
+#include "movegen.h"
+#include "search.h"
+#include "startpos.h"
+#include "tablebase.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * chess960-uci — движок без интерфейса по протоколу UCI, для оболочек турниров
+ * (cutechess-cli, Arena и т. п.) и скриптовых матчей.
+ *
+ * Поддерживаются команды uci, isready, ucinewgame, position (startpos | fen ... [moves ...]),
+ * go (depth, nodes, movetime, wtime/btime/winc/binc/movestogo, infinite, ponder),
+ * ponderhit, stop и quit; опции Hash, Threads, Ponder, UCI_Chess960, TablebasePath
+ * (каталог таблиц эндшпиля chess960-tbgen) и SearchStats (перед bestmove —
+ * "info string stats {...}" со статистикой поиска в JSON).
+ *
+ * С UCI_Chess960 рокировка записывается как «король берет ладью» (e1h1) — так же
+ * кодирует ее PackedMove; без опции — ходом короля на две клетки (e1g1). Позиция
+ * принимается в X-FEN и Shredder-FEN.
+ *
+ * Поиск идет в отдельном потоке, поэтому во время поиска читаются stop, ponderhit и isready.
+ */
+
+namespace {
+
+const char* const EngineName = "Chess960";
+const int DefaultHashMb = 16;
+const int MaxHashMb = 65536;
+const int MoveOverheadMs = 30;      // Запас на задержки оболочки.
+const int DefaultMovesToGo = 30;    // На сколько ходов делится оставшееся время без movestogo.
+
+/**
+ * @class UciEngine
+ * @brief Состояние сеанса UCI: позиция с историей хешей, поиск и его поток, опции.
+ */
+class UciEngine
+{
+public:
+    UciEngine();
+    ~UciEngine();
+
+    // Обрабатывает строку команды; false — пришел quit.
+    bool execute(const std::string& line);
+
+private:
+    void send(const std::string& line);
+    void waitForSearch();
+
+    void cmdUci();
+    void cmdSetOption(std::istringstream& input);
+    void cmdPosition(std::istringstream& input);
+    void cmdGo(std::istringstream& input);
+
+    // Запись хода в нотации UCI с учетом UCI_Chess960.
+    std::string formatMove(const Position& position, PackedMove move) const;
+    PackedMove parseUciMove(const Position& position, const std::string& text) const;
+    void reportIteration(const SearchResult& result);
+
+    Search m_search;
+    Position m_position;
+    std::vector<uint64_t> m_keys;       // Хеши позиций партии, включая текущую.
+    std::thread m_thread;
+    std::mutex m_outputMutex;
+    bool m_chess960 = false;
+    bool m_printStats = false;
+};
+
+UciEngine::UciEngine() {
+    setupStartPosition(m_position, ClassicalStartPosition);
+    m_keys.push_back(m_position.key());
+    m_search.setHashSizeMb(DefaultHashMb);
+    m_search.setProgressCallback([this](const SearchResult& result) { reportIteration(result); });
+}
+
+UciEngine::~UciEngine() {
+    m_search.stop();
+    waitForSearch();
+}
+
+void UciEngine::send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    std::fputs(line.c_str(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+void UciEngine::waitForSearch() {
+    if (m_thread.joinable()) m_thread.join();
+}
+
+bool UciEngine::execute(const std::string& line) {
+    std::istringstream input(line);
+    std::string command;
+    if (!(input >> command)) return true;
+
+    if (command == "uci") {
+        cmdUci();
+    } else if (command == "isready") {
+        send("readyok");
+    } else if (command == "setoption") {
+        cmdSetOption(input);
+    } else if (command == "ucinewgame") {
+        m_search.stop();
+        waitForSearch();
+        m_search.transpositionTable().clear();
+    } else if (command == "position") {
+        cmdPosition(input);
+    } else if (command == "go") {
+        cmdGo(input);
+    } else if (command == "stop") {
+        m_search.stop();
+        waitForSearch();
+    } else if (command == "ponderhit") {
+        m_search.ponderHit();
+    } else if (command == "quit") {
+        m_search.stop();
+        waitForSearch();
+        return false;
+    }
+    // Неизвестные команды протокол велит пропускать.
+    return true;
+}
+
+void UciEngine::cmdUci() {
+    send(std::string("id name ") + EngineName);
+    send("id author Chess960 contributors");
+    send("option name Hash type spin default " + std::to_string(DefaultHashMb) + " min 1 max " + std::to_string(MaxHashMb));
+    send("option name Threads type spin default 1 min 1 max " + std::to_string(Search::MaxThreads));
+    send("option name Ponder type check default false");
+    send("option name UCI_Chess960 type check default false");
+    send("option name TablebasePath type string default <empty>");
+    send("option name SearchStats type check default false");
+    send("uciok");
+}
+
+void UciEngine::cmdSetOption(std::istringstream& input) {
+    // setoption name <имя из нескольких слов> [value <значение>]
+    std::string token, name, value;
+    input >> token;
+    while (input >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+    std::getline(input >> std::ws, value);
+
+    m_search.stop();
+    waitForSearch();
+    if (name == "Hash") {
+        m_search.setHashSizeMb(static_cast<size_t>(std::clamp(std::atoi(value.c_str()), 1, MaxHashMb)));
+    } else if (name == "Threads") {
+        m_search.setThreads(std::clamp(std::atoi(value.c_str()), 1, Search::MaxThreads));
+    } else if (name == "UCI_Chess960") {
+        m_chess960 = value == "true";
+    } else if (name == "SearchStats") {
+        m_printStats = value == "true";
+    } else if (name == "TablebasePath") {
+        if (value.empty() || value == "<empty>") {
+            Tablebase::release();
+        } else {
+            int count = Tablebase::init(value);
+            send("info string " + std::to_string(count) + " tablebases loaded, up to "
+                 + std::to_string(Tablebase::largestTable()) + " pieces");
+        }
+    } else if (name != "Ponder") {
+        send("info string unknown option " + name);
+    }
+}
+
+void UciEngine::cmdPosition(std::istringstream& input) {
+    m_search.stop();
+    waitForSearch();
+
+    std::string token;
+    input >> token;
+    Position position;
+    if (token == "startpos") {
+        setupStartPosition(position, ClassicalStartPosition);
+        input >> token;  // "moves" или ничего.
+    } else if (token == "fen") {
+        std::string fen;
+        while (input >> token && token != "moves") fen += (fen.empty() ? "" : " ") + token;
+        if (!position.setFromFen(fen)) {
+            send("info string invalid fen " + fen);
+            return;
+        }
+    } else {
+        return;
+    }
+
+    std::vector<uint64_t> keys(1, position.key());
+    while (input >> token) {
+        PackedMove move = parseUciMove(position, token);
+        if (move == NullMove) {
+            send("info string illegal move " + token);
+            break;
+        }
+        UndoInfo undo;
+        position.makeMove(move, undo);
+        // До необратимого хода позиции повториться не могут: историю можно не хранить.
+        if (position.halfmoveClock() == 0) keys.clear();
+        keys.push_back(position.key());
+    }
+    m_position = position;
+    m_keys = std::move(keys);
+}
+
+void UciEngine::cmdGo(std::istringstream& input) {
+    m_search.stop();
+    waitForSearch();
+
+    SearchLimits limits;
+    int time[3] = { 0, 0, 0 }, increment[3] = { 0, 0, 0 };
+    int movesToGo = 0;
+    std::string token;
+    while (input >> token) {
+        if (token == "depth") input >> limits.depth;
+        else if (token == "nodes") input >> limits.nodes;
+        else if (token == "movetime") input >> limits.moveTimeMs;
+        else if (token == "wtime") input >> time[WHITE];
+        else if (token == "btime") input >> time[BLACK];
+        else if (token == "winc") input >> increment[WHITE];
+        else if (token == "binc") input >> increment[BLACK];
+        else if (token == "movestogo") input >> movesToGo;
+        // Бесконечный поиск — то же обдумывание: заканчивается только по stop.
+        else if (token == "infinite" || token == "ponder") limits.ponder = true;
+    }
+
+    // Контроль времени: доля оставшегося времени плюс большая часть добавки,
+    // но так, чтобы на часах остался запас.
+    PieceColor us = m_position.sideToMove();
+    if (limits.moveTimeMs == 0 && time[us] > 0) {
+        int budget = time[us] / (movesToGo > 0 ? movesToGo : DefaultMovesToGo) + increment[us] * 3 / 4;
+        limits.moveTimeMs = std::max(1, std::min(budget, time[us] - MoveOverheadMs));
+    }
+
+    Position root = m_position;
+    std::vector<uint64_t> keys = m_keys;
+    m_search.arm(limits);
+    m_thread = std::thread([this, root, keys, limits]() {
+        SearchResult result = m_search.think(root, limits, keys);
+        if (m_printStats) send("info string stats " + result.stats.toJson());
+        std::string line = "bestmove " + (result.bestMove == NullMove ? std::string("0000") : formatMove(root, result.bestMove));
+        if (result.pv.size() > 1) {
+            Position next = root;
+            UndoInfo undo;
+            next.makeMove(result.pv[0], undo);
+            line += " ponder " + formatMove(next, result.pv[1]);
+        }
+        send(line);
+    });
+}
+
+std::string UciEngine::formatMove(const Position& position, PackedMove move) const {
+    if (!m_chess960 && position.isCastlingMove(move)) {
+        // Классическая запись: король на g- или c-вертикаль.
+        int from = moveFrom(move), to = moveTo(move);
+        int kingTarget = makeSquare(squareRow(from), squareCol(to) > squareCol(from) ? 6 : 2);
+        return moveToString(packMove(from, kingTarget));
+    }
+    return moveToString(move);
+}
+
+PackedMove UciEngine::parseUciMove(const Position& position, const std::string& text) const {
+    MoveList legal;
+    generateLegalMoves(position, legal);
+    for (PackedMove move : legal) {
+        if (formatMove(position, move) == text) return move;
+    }
+    return NullMove;
+}
+
+void UciEngine::reportIteration(const SearchResult& result) {
+    std::string score;
+    if (isMateScore(result.score)) {
+        int plies = MateScore - std::abs(result.score);
+        score = "mate " + std::to_string(result.score > 0 ? (plies + 1) / 2 : -(plies + 1) / 2);
+    } else if (std::abs(result.score) > TbWinScore - MaxPly) {
+        // Выигрыш по таблицам эндшпиля: большая оценка, убывающая с расстоянием.
+        int distance = TbWinScore - std::abs(result.score);
+        score = "cp " + std::to_string(result.score > 0 ? 20000 - distance : distance - 20000);
+    } else {
+        score = "cp " + std::to_string(result.score);
+    }
+
+    uint64_t milliseconds = static_cast<uint64_t>(result.seconds * 1000);
+    uint64_t nps = result.seconds > 0 ? static_cast<uint64_t>(result.nodes / result.seconds) : 0;
+    std::string line = "info depth " + std::to_string(result.depth)
+                       + " seldepth " + std::to_string(result.stats.totals.selDepth) + " score " + score
+                       + " nodes " + std::to_string(result.nodes) + " nps " + std::to_string(nps)
+                       + " hashfull " + std::to_string(m_search.transpositionTable().hashfull())
+                       + " time " + std::to_string(milliseconds) + " pv";
+    Position position = m_position;
+    for (PackedMove move : result.pv) {
+        line += " " + formatMove(position, move);
+        UndoInfo undo;
+        position.makeMove(move, undo);
+    }
+    send(line);
+}
+
+} // namespace
+
+int main() {
+    UciEngine engine;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!engine.execute(line)) return 0;
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "chess_types.h"
+#include <cstdint>
+
+/**
+ * Ключи Зобриста для 64-битного хеша позиции.
+ *
+ * Хеш — XOR ключей всех фигур на своих клетках, очереди хода (если ходят черные),
+ * прав на рокировку (по цвету и вертикали ладьи, что однозначно для Chess960)
+ * и вертикали взятия на проходе. Таблица строится при компиляции
+ * детерминированным генератором, поэтому хеши одинаковы между запусками и машинами.
+ */
+namespace Zobrist {
+
+struct Keys {
+    uint64_t pieces[3][7][64]; // [цвет][тип][клетка]
+    uint64_t castling[3][8];   // [цвет][вертикаль ладьи]
+    uint64_t enPassant[8];     // [вертикаль]
+    uint64_t blackToMove;
+};
+
+// xorshift64* — достаточно для равномерных ключей.
+constexpr uint64_t nextRandom(uint64_t& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+constexpr Keys makeKeys() {
+    Keys keys{};
+    uint64_t state = 1070372ULL;
+    for (int color = WHITE; color <= BLACK; ++color)
+        for (int type = KING; type <= PAWN; ++type)
+            for (int square = 0; square < 64; ++square)
+                keys.pieces[color][type][square] = nextRandom(state);
+    for (int color = WHITE; color <= BLACK; ++color)
+        for (int file = 0; file < 8; ++file)
+            keys.castling[color][file] = nextRandom(state);
+    for (int file = 0; file < 8; ++file) keys.enPassant[file] = nextRandom(state);
+    keys.blackToMove = nextRandom(state);
+    return keys;
+}
+
+inline constexpr Keys keys = makeKeys();
+
+inline uint64_t piece(Piece p, int square) { return keys.pieces[p.color][p.type][square]; }
+
+} // namespace Zobrist
+
+#endif // ZOBRIST_H